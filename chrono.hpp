@@ -3,3 +3,6 @@
 #include <eon/chrono/timer.hpp>
 #include <eon/chrono/auto_timer.hpp>
 #include <eon/chrono/time_unit.hpp>
+#include <eon/chrono/benchmark.hpp>
+#include <eon/chrono/tsc_clock.hpp>
+#include <eon/chrono/perf_timer.hpp>
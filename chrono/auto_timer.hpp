@@ -16,9 +16,11 @@ namespace eon::chrono {
      * @brief std::chrono based auto timer for ostreams of <b>CharT</b> with traits <b>Traits</b>
      * @tparam Rep an arithmetic type representing the number of ticks
      * @tparam Period <b>std::ratio</b> representing the tick period
+     * @tparam Clock clock to read
      */
-    template <typename Rep, typename Period, typename CharT, typename Traits = std::char_traits<CharT>, writing_time_unit Opt = writing_time_unit::enable>
-    class basic_auto_timer : public timer<Rep, Period> {
+    template <typename Rep, typename Period, typename CharT, typename Traits = std::char_traits<CharT>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    class basic_auto_timer : public timer<Rep, Period, Clock> {
     public:
         explicit basic_auto_timer(std::basic_ostream<CharT, Traits> & os): m_os(os) {
             this->reset();
@@ -43,21 +45,26 @@ namespace eon::chrono {
         std::basic_ostream<CharT, Traits> & m_os;
     };
 
-    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable>
-    using auto_timer = basic_auto_timer<Rep, Period, char, std::char_traits<char>, Opt>;
+    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    using auto_timer = basic_auto_timer<Rep, Period, char, std::char_traits<char>, Opt, Clock>;
 
-    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable>
-    using wauto_timer = basic_auto_timer<Rep, Period, wchar_t, std::char_traits<wchar_t>, Opt>;
+    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    using wauto_timer = basic_auto_timer<Rep, Period, wchar_t, std::char_traits<wchar_t>, Opt, Clock>;
 
-    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable>
-    using u16auto_timer = basic_auto_timer<Rep, Period, char16_t, std::char_traits<char16_t>, Opt>;
+    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    using u16auto_timer = basic_auto_timer<Rep, Period, char16_t, std::char_traits<char16_t>, Opt, Clock>;
 
-    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable>
-    using u32auto_timer = basic_auto_timer<Rep, Period, char32_t, std::char_traits<char32_t>, Opt>;
+    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    using u32auto_timer = basic_auto_timer<Rep, Period, char32_t, std::char_traits<char32_t>, Opt, Clock>;
 
 #ifdef __cpp_lib_char8_t
-    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable>
-    using u8auto_timer = basic_auto_timer<Rep, Period, char8_t, std::char_traits<char8_t>, Opt>;
+    template <typename Rep = double, typename Period = std::ratio<1>, writing_time_unit Opt = writing_time_unit::enable,
+              typename Clock = std::chrono::steady_clock>
+    using u8auto_timer = basic_auto_timer<Rep, Period, char8_t, std::char_traits<char8_t>, Opt, Clock>;
 #endif
 
 }
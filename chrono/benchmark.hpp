@@ -0,0 +1,256 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <concepts>
+#include <type_traits>
+#include <memory>
+#include <ostream>
+#include <cmath>
+#include <cstddef>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include <eon/chrono/timer.hpp>
+#include <eon/chrono/time_unit.hpp>
+
+namespace eon::chrono {
+
+    /**
+     * @brief makes the compiler assume <b>value</b> is read, so the computation of it is not optimized away
+     */
+    template <typename T>
+    inline void do_not_optimize(T const & value) {
+#if defined(__GNUC__) || defined(__clang__)
+        if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void *)) {
+            asm volatile("" : : "r,m"(value) : "memory");
+        }
+        else {
+            asm volatile("" : : "m"(value) : "memory");
+        }
+#else
+        static_cast<void>(*reinterpret_cast<char const volatile *>(std::addressof(value)));
+        _ReadWriteBarrier();
+#endif
+    }
+
+    /**
+     * @brief makes the compiler assume <b>value</b> is read and modified, so it is neither optimized away nor kept in a register
+     * between iterations
+     */
+    template <typename T>
+    inline void do_not_optimize(T & value) {
+#if defined(__GNUC__) || defined(__clang__)
+        if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void *)) {
+            asm volatile("" : "+m,r"(value) : : "memory");
+        }
+        else {
+            asm volatile("" : "+m"(value) : : "memory");
+        }
+#else
+        static_cast<void>(*reinterpret_cast<char const volatile *>(std::addressof(value)));
+        _ReadWriteBarrier();
+#endif
+    }
+
+    /**
+     * @brief makes the compiler assume all memory is read and written, so pending stores are not optimized away
+     */
+    inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        _ReadWriteBarrier();
+#endif
+    }
+
+    struct benchmark_options {
+        std::chrono::nanoseconds warmup = std::chrono::milliseconds(50);
+        std::chrono::nanoseconds sample_time = std::chrono::milliseconds(1); ///< the iterations per sample are calibrated to take this long
+        std::size_t samples = 100;
+        double outlier_factor = 1.5; ///< samples farther than outlier_factor * IQR from the quartiles are rejected, 0 keeps all
+    };
+
+    /**
+     * @brief Statistics of the time of one iteration over the samples left after outlier rejection
+     */
+    template <typename Duration>
+    struct benchmark_result {
+        std::size_t iterations = 0; ///< iterations per sample
+        std::size_t samples = 0;    ///< samples kept
+        std::size_t outliers = 0;   ///< samples rejected
+        Duration min{};
+        Duration median{};
+        Duration mean{};
+        Duration p99{};
+        Duration max{};
+        Duration stddev{};
+    };
+
+    template <typename CharT, typename Traits, typename Rep, typename Period>
+    std::basic_ostream<CharT, Traits> & operator<<(std::basic_ostream<CharT, Traits> & os, benchmark_result<std::chrono::duration<Rep, Period>> const & result) {
+        constexpr auto unit = get_time_unit<Period, CharT>();
+        auto const write = [&os, unit](char const * name, std::chrono::duration<Rep, Period> const value) {
+            for (; *name != '\0'; ++name) {
+                os << os.widen(*name);
+            }
+            os << value.count() << unit;
+        };
+
+        write("min ", result.min);
+        write(", median ", result.median);
+        write(", mean ", result.mean);
+        write(", p99 ", result.p99);
+        write(", max ", result.max);
+        write(", stddev ", result.stddev);
+        return os;
+    }
+
+    namespace detail {
+
+        /**
+         * @brief returns the linearly interpolated <b>quantile</b> (0..1) of the sorted non-empty <b>values</b>
+         */
+        [[nodiscard]] inline double quantile(std::vector<double> const & values, double const quantile) noexcept {
+            double const position = quantile * static_cast<double>(values.size() - 1);
+            auto const lower = static_cast<std::size_t>(position);
+            std::size_t const upper = std::min(lower + 1, values.size() - 1);
+            return values[lower] + (values[upper] - values[lower]) * (position - static_cast<double>(lower));
+        }
+
+    }
+
+    /**
+     * @brief Statistical micro-benchmark: warms up, calibrates the number of iterations per sample to
+     * <b>benchmark_options::sample_time</b>, so reading the clock costs little compared to a sample, takes the samples,
+     * rejects the outliers by Tukey's fences and reports the statistics of one iteration
+     * @tparam Rep an arithmetic type representing the number of ticks of the results
+     * @tparam Period <b>std::ratio</b> representing the tick period of the results
+     * @tparam Clock clock to time the samples with
+     */
+    template <typename Rep = double, typename Period = std::nano, typename Clock = std::chrono::steady_clock>
+    class benchmark {
+        using sample_timer = timer<double, std::nano, Clock>;
+
+    public:
+        using rep_type = Rep;
+        using period_type = Period;
+        using duration_type = std::chrono::duration<rep_type, period_type>;
+        using result_type = benchmark_result<duration_type>;
+
+        /**
+         * @brief measures <b>callable</b> invoked with <b>args</b>. The arguments are passed to do_not_optimize before every
+         * call, so the compiler can't hoist work on them out of the loop, and the result, if any, after it
+         * @param options warmup, sample time, the number of samples and the outlier rejection factor
+         * @param callable any object that can be invoked with <b>args</b>
+         * @param args arguments to pass to <b>callable</b> on every iteration
+         */
+        template <typename... Args, std::invocable<Args &...> Callable>
+        static result_type run(benchmark_options const & options, Callable && callable, Args &&... args) {
+            auto const iteration = [&callable, &args...] {
+                (do_not_optimize(args), ...);
+                if constexpr (std::is_void_v<std::invoke_result_t<Callable &, Args &...>>) {
+                    std::invoke(callable, args...);
+                    clobber_memory();
+                }
+                else {
+                    do_not_optimize(std::invoke(callable, args...));
+                }
+            };
+
+            auto const batch = [&iteration](std::size_t const iterations) {
+                sample_timer const timer;
+                for (std::size_t i = 0; i < iterations; ++i) {
+                    iteration();
+                }
+                return timer.duration();
+            };
+
+            std::size_t const iterations = calibrate(options, batch);
+            std::vector<double> samples;
+            samples.reserve(options.samples);
+            for (std::size_t i = 0; i < std::max<std::size_t>(options.samples, 1); ++i) {
+                samples.push_back(batch(iterations).count() / static_cast<double>(iterations));
+            }
+
+            return statistics(std::move(samples), iterations, options.outlier_factor);
+        }
+
+        /**
+         * @brief measures <b>callable</b> invoked with <b>args</b> with the default options
+         */
+        template <typename... Args, std::invocable<Args &...> Callable>
+        static result_type run(Callable && callable, Args &&... args) {
+            return run(benchmark_options{}, std::forward<Callable>(callable), std::forward<Args>(args)...);
+        }
+
+    private:
+        /**
+         * @brief runs batches for the warmup time and returns the number of iterations whose batch takes about the sample time.
+         * Batches too short to be timed precisely grow tenfold
+         */
+        template <typename Batch>
+        [[nodiscard]] static std::size_t calibrate(benchmark_options const & options, Batch & batch) {
+            using ns = std::chrono::duration<double, std::nano>;
+
+            ns const sample_time(options.sample_time);
+            sample_timer const warmup;
+            std::size_t iterations = 1;
+            while (true) {
+                ns const elapsed = batch(iterations);
+                bool const precise = elapsed >= sample_time / 10 && elapsed.count() > 0;
+                if (precise) {
+                    iterations = std::max<std::size_t>(static_cast<std::size_t>(std::llround(static_cast<double>(iterations) * (sample_time / elapsed))), 1);
+                }
+                else if (sample_time.count() > 0) {
+                    iterations *= 10;
+                }
+
+                if ((precise || sample_time.count() <= 0) && warmup.duration() >= ns(options.warmup)) {
+                    return iterations;
+                }
+            }
+        }
+
+        [[nodiscard]] static result_type statistics(std::vector<double> samples, std::size_t const iterations, double const outlier_factor) {
+            std::ranges::sort(samples);
+            std::size_t const all = samples.size();
+            if (outlier_factor > 0) {
+                double const q1 = detail::quantile(samples, 0.25);
+                double const q3 = detail::quantile(samples, 0.75);
+                double const low = q1 - outlier_factor * (q3 - q1);
+                double const high = q3 + outlier_factor * (q3 - q1);
+                std::erase_if(samples, [low, high](double const sample) { return sample < low || sample > high; });
+            }
+
+            double const mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+            double squares = 0;
+            for (double const sample : samples) {
+                squares += (sample - mean) * (sample - mean);
+            }
+            double const stddev = samples.size() > 1 ? std::sqrt(squares / static_cast<double>(samples.size() - 1)) : 0.0;
+
+            auto const duration = [](double const ns) {
+                return std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::nano>(ns));
+            };
+
+            return {
+                .iterations = iterations,
+                .samples = samples.size(),
+                .outliers = all - samples.size(),
+                .min = duration(samples.front()),
+                .median = duration(detail::quantile(samples, 0.5)),
+                .mean = duration(mean),
+                .p99 = duration(detail::quantile(samples, 0.99)),
+                .max = duration(samples.back()),
+                .stddev = duration(stddev)
+            };
+        }
+    };
+
+}
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <unordered_set>
+
+#include <eon/chrono.hpp>
+
+
+[[nodiscard]] long long sum(std::vector<int> const & v) {
+    return std::accumulate(v.begin(), v.end(), 0ll);
+}
+
+[[nodiscard]] bool contains(std::vector<int> const & v, int const value) {
+    return std::ranges::find(v, value) != v.end();
+}
+
+[[nodiscard]] bool contains(std::unordered_set<int> const & set, int const value) {
+    return set.contains(value);
+}
+
+int main() {
+    std::vector<int> v(10'000);
+    std::iota(v.begin(), v.end(), 0);
+    std::unordered_set<int> const set(v.begin(), v.end());
+
+    std::cout << "Sum of 10'000 ints: " << eon::chrono::benchmark<double, std::micro>::run(sum, v) << '\n';
+
+    int value = 9'999;
+    auto const vector_result = eon::chrono::benchmark<>::run([&v, &value] {
+        eon::chrono::do_not_optimize(value);
+        return contains(v, value);
+    });
+    std::cout << "Find in vector: " << vector_result << '\n';
+
+    eon::chrono::benchmark_options const options{.samples = 1000, .outlier_factor = 3};
+    auto const set_result = eon::chrono::benchmark<>::run(options, [&set, &value] {
+        eon::chrono::do_not_optimize(value);
+        return contains(set, value);
+    });
+    std::cout << "Find in unordered_set: " << set_result << " (" << set_result.outliers << " outliers rejected)\n";
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <chrono>
+#include <array>
+#include <optional>
+#include <functional>
+#include <concepts>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <eon/chrono/timer.hpp>
+#include <eon/chrono/time_unit.hpp>
+
+namespace eon::chrono {
+
+    /**
+     * @brief Wall time and hardware counters of a measured region. A counter is empty if the CPU, the kernel or the
+     * permissions (e.g. in a container) don't allow reading it
+     */
+    template <typename Duration>
+    struct perf_measurement {
+        Duration duration{};
+        std::optional<double> cycles;
+        std::optional<double> instructions;
+        std::optional<double> cache_misses;
+        std::optional<double> branch_misses;
+
+        /**
+         * @brief returns whether any hardware counter was read
+         */
+        [[nodiscard]] bool has_counters() const noexcept {
+            return cycles || instructions || cache_misses || branch_misses;
+        }
+
+        /**
+         * @brief returns instructions per cycle
+         */
+        [[nodiscard]] std::optional<double> ipc() const noexcept {
+            if (!cycles || !instructions || *cycles == 0) {
+                return std::nullopt;
+            }
+            return *instructions / *cycles;
+        }
+    };
+
+    template <typename CharT, typename Traits, typename Rep, typename Period>
+    std::basic_ostream<CharT, Traits> & operator<<(std::basic_ostream<CharT, Traits> & os, perf_measurement<std::chrono::duration<Rep, Period>> const & measurement) {
+        auto const write = [&os](char const * text) {
+            for (; *text != '\0'; ++text) {
+                os << os.widen(*text);
+            }
+        };
+        auto const write_counter = [&os, &write](std::optional<double> const & counter, char const * name) {
+            if (counter) {
+                write(", ");
+                os << *counter;
+                write(name);
+            }
+        };
+
+        os << measurement.duration.count() << get_time_unit<Period, CharT>();
+        if (!measurement.has_counters()) {
+            write(", counters unavailable");
+            return os;
+        }
+
+        write_counter(measurement.cycles, " cycles");
+        write_counter(measurement.instructions, " instructions");
+        if (auto const ipc = measurement.ipc()) {
+            write(" (IPC ");
+            os << *ipc;
+            write(")");
+        }
+        write_counter(measurement.cache_misses, " cache misses");
+        write_counter(measurement.branch_misses, " branch misses");
+        return os;
+    }
+
+    namespace detail {
+
+        /**
+         * @brief Hardware counters of the calling thread opened with perf_event_open as one group, so they are started,
+         * stopped and read together. Counters which can't be opened are skipped, without perf events the group is empty
+         */
+        class perf_event_group {
+        public:
+            static constexpr std::size_t events = 4;
+
+            perf_event_group() noexcept {
+#if defined(__linux__)
+                constexpr std::array<std::uint64_t, events> configs = {
+                    PERF_COUNT_HW_CPU_CYCLES,
+                    PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_CACHE_MISSES,
+                    PERF_COUNT_HW_BRANCH_MISSES
+                };
+
+                for (std::size_t i = 0; i < events; ++i) {
+                    perf_event_attr attr{};
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.size = sizeof(attr);
+                    attr.config = configs[i];
+                    attr.disabled = m_leader < 0;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                    auto const fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+                    if (fd < 0) {
+                        continue;
+                    }
+                    if (m_leader < 0) {
+                        m_leader = fd;
+                    }
+                    m_fds[i] = fd;
+                    m_order[m_opened++] = i;
+                }
+#endif
+            }
+
+            perf_event_group(perf_event_group const &) = delete;
+            perf_event_group & operator=(perf_event_group const &) = delete;
+
+            ~perf_event_group() {
+#if defined(__linux__)
+                // members first, the leader last
+                for (std::size_t i = m_opened; i > 0; --i) {
+                    ::close(m_fds[m_order[i - 1]]);
+                }
+#endif
+            }
+
+            /**
+             * @brief zeroes the counters and starts counting
+             */
+            void start() noexcept {
+#if defined(__linux__)
+                if (m_leader >= 0) {
+                    ::ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                    ::ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                }
+#endif
+            }
+
+            /**
+             * @brief returns the counts since start() in the order cycles, instructions, cache misses, branch misses.
+             * Counts are scaled up if the kernel multiplexed the group with other events
+             */
+            [[nodiscard]] std::array<std::optional<double>, events> read() const noexcept {
+                std::array<std::optional<double>, events> counts{};
+#if defined(__linux__)
+                if (m_leader < 0) {
+                    return counts;
+                }
+
+                // nr, time enabled, time running, then one value per counter
+                std::array<std::uint64_t, 3 + events> buffer{};
+                if (::read(m_leader, buffer.data(), sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) {
+                    return counts;
+                }
+
+                std::uint64_t const enabled = buffer[1];
+                std::uint64_t const running = buffer[2];
+                if (running == 0) {
+                    return counts;
+                }
+
+                double const scale = static_cast<double>(enabled) / static_cast<double>(running);
+                for (std::size_t i = 0; i < m_opened && i < buffer[0]; ++i) {
+                    counts[m_order[i]] = static_cast<double>(buffer[3 + i]) * scale;
+                }
+#endif
+                return counts;
+            }
+
+        private:
+            int m_leader = -1;
+            std::array<int, events> m_fds{-1, -1, -1, -1};
+            std::array<std::size_t, events> m_order{};  // event index of every opened counter in the group order
+            std::size_t m_opened = 0;
+        };
+
+    }
+
+    /**
+     * @brief Timer reading hardware counters (cycles, instructions, cache misses, branch misses) of the calling thread
+     * through Linux perf_event_open along with wall time. Where perf events are unavailable (other systems, containers,
+     * <b>perf_event_paranoid</b> forbidding it) it measures wall time only
+     * @tparam Rep an arithmetic type representing the number of ticks
+     * @tparam Period <b>std::ratio</b> representing the tick period
+     * @tparam Clock clock to read
+     */
+    template <typename Rep = double, typename Period = std::ratio<1>, typename Clock = std::chrono::steady_clock>
+    class perf_timer {
+        using wall_timer = timer<Rep, Period, Clock>;
+
+    public:
+        using rep_type = Rep;
+        using period_type = Period;
+        using duration_type = std::chrono::duration<rep_type, period_type>;
+        using clock_type = Clock;
+        using measurement_type = perf_measurement<duration_type>;
+
+    public:
+        /**
+         * @brief opens the counters and starts counting
+         */
+        perf_timer() {
+            m_counters.start();
+            m_timer.reset();
+        }
+
+        perf_timer(perf_timer const &) = delete;
+        perf_timer & operator=(perf_timer const &) = delete;
+
+        /**
+         * @brief returns elapsed duration and counters
+         */
+        [[nodiscard]] measurement_type measurement() const {
+            duration_type const duration = m_timer.duration();
+            auto const [cycles, instructions, cache_misses, branch_misses] = m_counters.read();
+            return {duration, cycles, instructions, cache_misses, branch_misses};
+        }
+
+        /**
+         * @brief resets the timer and the counters
+         */
+        void reset() {
+            m_counters.start();
+            m_timer.reset();
+        }
+
+        /**
+         * @brief returns callable's execution duration and counters
+         * @param callable any object that can be invoked with <b>args</b>
+         * @param args arguments to pass to <b>callable</b>
+         */
+        template <typename... Args, std::invocable<Args...> Callable>
+        static measurement_type measure(Callable && callable, Args &&... args) {
+            perf_timer const timer;
+            std::invoke(std::forward<Callable>(callable), std::forward<Args>(args)...);
+            return timer.measurement();
+        }
+
+        /**
+         * @brief executes <b>callable</b> object <b>count</b> times and returns the average execution duration and counters.
+         * The counters are opened once for all the iterations
+         * @param count count of iterations
+         * @param callable any object that can be invoked with <b>args</b>
+         * @param args arguments to pass to <b>callable</b>
+         */
+        template <typename... Args, std::invocable<Args...> Callable>
+        static measurement_type avg_measure(std::size_t count, Callable && callable, Args &&... args) {
+            perf_timer const timer;
+            for (std::size_t i = 0; i < count; ++i) {
+                std::invoke(callable, args...);
+            }
+            measurement_type measurement = timer.measurement();
+            if (count == 0) {
+                return measurement;
+            }
+
+            auto const average = [count](std::optional<double> & counter) {
+                if (counter) {
+                    *counter /= static_cast<double>(count);
+                }
+            };
+
+            measurement.duration = static_cast<duration_type>(measurement.duration / static_cast<rep_type>(count));
+            average(measurement.cycles);
+            average(measurement.instructions);
+            average(measurement.cache_misses);
+            average(measurement.branch_misses);
+            return measurement;
+        }
+
+    private:
+        detail::perf_event_group m_counters;
+        wall_timer m_timer;
+    };
+
+}
@@ -13,14 +13,15 @@ namespace eon::chrono {
      * @brief std::chrono based timer
      * @tparam Rep an arithmetic type representing the number of ticks
      * @tparam Period <b>std::ratio</b> representing the tick period
+     * @tparam Clock clock to read, e.g. <b>eon::chrono::tsc_clock</b> for cheaper reads
      */
-    template <typename Rep = double, typename Period = std::ratio<1>>
+    template <typename Rep = double, typename Period = std::ratio<1>, typename Clock = std::chrono::steady_clock>
     class timer {
     public:
         using rep_type = Rep;
         using period_type = Period;
         using duration_type = std::chrono::duration<rep_type, period_type>;
-        using clock_type = std::chrono::steady_clock;
+        using clock_type = Clock;
 
     public:
         /**
@@ -52,7 +53,7 @@ namespace eon::chrono {
         /**
          * @brief returns the time point which from the timer started counting
          */
-        [[nodiscard]] clock_type::time_point time_point() const noexcept {
+        [[nodiscard]] typename clock_type::time_point time_point() const noexcept {
             return m_start;
         }
 
@@ -133,7 +134,7 @@ namespace eon::chrono {
         }
 
     private:
-        clock_type::time_point m_start;
+        typename clock_type::time_point m_start;
     };
 
 }
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define EON_CHRONO_HAS_TSC
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#endif
+
+namespace eon::chrono {
+
+    /**
+     * @brief Defines how <b>eon::chrono::basic_tsc_clock</b> orders reading the time stamp counter with the surrounding code
+     */
+    enum class tsc_fence {
+        none,       ///< <b>rdtsc</b>: the cheapest, the CPU may execute it before the preceding or after the following instructions
+        serialized, ///< <b>lfence; rdtsc</b>: the counter is read after the preceding instructions have completed
+        rdtscp      ///< <b>rdtscp; lfence</b>: after the preceding instructions have completed and before the following ones start
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Ratio between the time stamp counter and std::chrono::steady_clock measured on the first use.
+         * <b>invariant</b> is false if the CPU has no invariant TSC (it may stop or change its rate), then the clocks fall back
+         * to std::chrono::steady_clock
+         */
+        struct tsc_calibration {
+            bool invariant = false;
+            std::uint64_t base_ticks = 0;
+            std::chrono::steady_clock::time_point base_time;
+            double ns_per_tick = 0;
+
+            [[nodiscard]] static tsc_calibration const & instance() {
+                static tsc_calibration const calibration = calibrate();
+                return calibration;
+            }
+
+        private:
+            [[nodiscard]] static tsc_calibration calibrate() {
+                tsc_calibration calibration;
+#ifdef EON_CHRONO_HAS_TSC
+                if (!has_invariant_tsc()) {
+                    return calibration;
+                }
+
+                // the TSC is read between two steady_clock reads, so the pairs are taken as close together as possible
+                auto const sample = [] {
+                    auto const before = std::chrono::steady_clock::now();
+                    std::uint64_t const ticks = __rdtsc();
+                    auto const after = std::chrono::steady_clock::now();
+                    return std::pair(ticks, before + (after - before) / 2);
+                };
+
+                auto const [first_ticks, first_time] = sample();
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                auto const [last_ticks, last_time] = sample();
+
+                std::chrono::duration<double, std::nano> const elapsed = last_time - first_time;
+                if (last_ticks <= first_ticks || elapsed.count() <= 0) {
+                    return calibration;
+                }
+
+                calibration.invariant = true;
+                calibration.base_ticks = last_ticks;
+                calibration.base_time = last_time;
+                calibration.ns_per_tick = elapsed.count() / static_cast<double>(last_ticks - first_ticks);
+#endif
+                return calibration;
+            }
+
+#ifdef EON_CHRONO_HAS_TSC
+            [[nodiscard]] static bool has_invariant_tsc() noexcept {
+                constexpr unsigned power_management_leaf = 0x80000007;
+                constexpr unsigned invariant_tsc_bit = 1u << 8;
+#if defined(_MSC_VER) && !defined(__clang__)
+                int registers[4]{};
+                __cpuid(registers, static_cast<int>(0x80000000));
+                if (static_cast<unsigned>(registers[0]) < power_management_leaf) {
+                    return false;
+                }
+                __cpuid(registers, static_cast<int>(power_management_leaf));
+                return (static_cast<unsigned>(registers[3]) & invariant_tsc_bit) != 0;
+#else
+                unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+                if (__get_cpuid_max(0x80000000, nullptr) < power_management_leaf
+                    || !__get_cpuid(power_management_leaf, &eax, &ebx, &ecx, &edx)) {
+                    return false;
+                }
+                return (edx & invariant_tsc_bit) != 0;
+#endif
+            }
+#endif
+        };
+
+    }
+
+    /**
+     * @brief Clock reading the CPU's invariant time stamp counter, which costs a few nanoseconds instead of a steady_clock call.
+     * Ticks are converted to nanoseconds with the ratio calibrated against std::chrono::steady_clock on the first use
+     * (which takes about 10ms), time points share the steady_clock epoch. Without an invariant TSC it is std::chrono::steady_clock
+     * @tparam Fence how reading the counter is ordered with the surrounding code
+     */
+    template <tsc_fence Fence = tsc_fence::none>
+    class basic_tsc_clock {
+    public:
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<basic_tsc_clock, duration>;
+
+        static constexpr bool is_steady = true;
+
+        [[nodiscard]] static time_point now() noexcept {
+            detail::tsc_calibration const & calibration = detail::tsc_calibration::instance();
+            if (!calibration.invariant) {
+                return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()));
+            }
+
+            auto const ticks = static_cast<double>(static_cast<std::int64_t>(read() - calibration.base_ticks));
+            return time_point(std::chrono::duration_cast<duration>(calibration.base_time.time_since_epoch())
+                              + duration(static_cast<rep>(ticks * calibration.ns_per_tick)));
+        }
+
+        /**
+         * @brief returns whether the clock reads the time stamp counter rather than falling back to std::chrono::steady_clock
+         */
+        [[nodiscard]] static bool is_invariant() {
+            return detail::tsc_calibration::instance().invariant;
+        }
+
+        /**
+         * @brief returns the number of counter ticks per second, 0 if the clock falls back to std::chrono::steady_clock
+         */
+        [[nodiscard]] static double frequency() {
+            detail::tsc_calibration const & calibration = detail::tsc_calibration::instance();
+            return calibration.invariant ? 1e9 / calibration.ns_per_tick : 0.0;
+        }
+
+        /**
+         * @brief returns the raw counter value
+         */
+        [[nodiscard]] static std::uint64_t read() noexcept {
+#ifdef EON_CHRONO_HAS_TSC
+            if constexpr (Fence == tsc_fence::serialized) {
+                _mm_lfence();
+                return __rdtsc();
+            }
+            else if constexpr (Fence == tsc_fence::rdtscp) {
+                unsigned aux;
+                std::uint64_t const ticks = __rdtscp(&aux);
+                _mm_lfence();
+                return ticks;
+            }
+            else {
+                return __rdtsc();
+            }
+#else
+            return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+    };
+
+    using tsc_clock = basic_tsc_clock<>;
+
+}
@@ -2,5 +2,17 @@
 
 #include <eon/mt/algorithms.hpp>
 #include <eon/mt/unique_lock.hpp>
+#include <eon/mt/shared_lock.hpp>
+#include <eon/mt/lock_profiler.hpp>
+#include <eon/mt/histogram.hpp>
+#include <eon/mt/strand.hpp>
+#include <eon/mt/pipeline.hpp>
+#include <eon/mt/mutex.hpp>
 #include <eon/mt/thread_pool.hpp>
+#include <eon/mt/mpmc_queue.hpp>
+#include <eon/mt/small_task.hpp>
+#include <eon/mt/future.hpp>
+#include <eon/mt/coroutine.hpp>
 #include <eon/mt/concurrency_info.hpp>
+#include <eon/mt/topology.hpp>
+#include <eon/mt/affinity.hpp>
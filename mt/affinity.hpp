@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <eon/mt/topology.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Defines how the workers of a thread pool are pinned to CPUs
+     */
+    enum class placement {
+        none,       ///< workers are not pinned, the scheduler moves them freely
+        compact,    ///< one CPU per worker, filling a core's SMT siblings, then the next core of the same node
+        scatter,    ///< one CPU per worker, spreading the workers across the nodes and cores before using SMT siblings
+        per_node    ///< workers are assigned to the NUMA nodes in turn and may run on any CPU of their node
+    };
+
+    namespace detail {
+
+        /**
+         * @brief returns the CPU sets workers are pinned to in turn: single CPUs for compact and scatter, whole nodes for per_node.
+         * Empty for placement::none
+         */
+        [[nodiscard]] inline std::vector<topology::cpu_group> placement_slots(topology const & topology, placement const placement) {
+            if (placement == placement::none || topology.cpus().empty()) {
+                return {};
+            }
+
+            if (placement == placement::per_node) {
+                return {topology.nodes().begin(), topology.nodes().end()};
+            }
+
+            using key_t = std::tuple<std::size_t, std::size_t, std::size_t>;
+            std::vector<std::pair<key_t, unsigned>> keyed;
+            keyed.reserve(topology.cpus().size());
+
+            for (logical_cpu const & cpu : topology.cpus()) {
+                auto const & core = topology.cores()[cpu.core];
+                auto const & node = topology.nodes()[cpu.node];
+                // position of the CPU among its SMT siblings and of its core among the cores of its node
+                auto const sibling_rank = static_cast<std::size_t>(std::ranges::find(core, cpu.id) - core.begin());
+                auto const core_rank = static_cast<std::size_t>(std::ranges::find(node, core.front()) - node.begin());
+
+                key_t const key = placement == placement::compact ? key_t{cpu.node, core_rank, sibling_rank}
+                                                                  : key_t{sibling_rank, core_rank, cpu.node};
+                keyed.emplace_back(key, cpu.id);
+            }
+            std::ranges::sort(keyed);
+
+            std::vector<topology::cpu_group> slots;
+            slots.reserve(keyed.size());
+            for (auto const & [key, id] : keyed) {
+                slots.push_back({id});
+            }
+            return slots;
+        }
+
+        /**
+         * @brief returns the NUMA node of the CPUs in <b>cpus</b>, 0 if they are empty
+         */
+        [[nodiscard]] inline std::size_t cpus_node(topology const & topology, topology::cpu_group const & cpus) noexcept {
+            logical_cpu const * const cpu = cpus.empty() ? nullptr : topology.find(cpus.front());
+            return cpu != nullptr ? cpu->node : 0;
+        }
+
+        /**
+         * @brief pins <b>thread</b> to <b>cpus</b>. Does nothing if they are empty or the platform doesn't support it
+         * @return true if the thread was pinned
+         */
+        inline bool set_affinity([[maybe_unused]] std::thread::native_handle_type const thread, topology::cpu_group const & cpus) noexcept {
+            if (cpus.empty()) {
+                return false;
+            }
+
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (unsigned const cpu : cpus) {
+                if (cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+
+    }
+
+}
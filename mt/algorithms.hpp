@@ -5,11 +5,35 @@
 #include <algorithm>
 #include <execution>
 #include <future>
+#include <latch>
+#include <memory>
+#include <exception>
+#include <stop_token>
+#include <functional>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include <eon/mt/concurrency_info.hpp>
+#include <eon/mt/future.hpp>
 
 namespace eon::mt {
 
+    /**
+     * @brief Defines how a range is split into chunks
+     */
+    enum class chunking {
+        equal,      ///< static split into one equal chunk per thread
+        dynamic,    ///< chunks of <b>grain_size</b> elements, threads claim the next one once they are done with the previous
+        guided      ///< like dynamic, but the chunks shrink from remaining / (2 * threads) down to <b>grain_size</b>
+    };
+
+    struct chunk_policy {
+        chunking mode = chunking::equal;
+        std::size_t grain_size = 0; ///< 0 chooses it automatically
+    };
+
     namespace detail {
 
         [[nodiscard]] inline std::vector<std::size_t> get_chunks_sizes(std::size_t size, std::size_t threads_count) {
@@ -20,22 +44,189 @@ namespace eon::mt {
             return chunks_sizes;
         }
 
+        [[nodiscard]] inline std::vector<std::size_t> get_chunks_sizes(std::size_t size, std::size_t threads_count, chunk_policy const policy) {
+            switch (policy.mode) {
+                case chunking::dynamic: {
+                    // ~8 chunks per thread are enough to even out the load without contending on the index
+                    std::size_t const grain_size = policy.grain_size != 0 ? policy.grain_size : std::max<std::size_t>(1, size / (threads_count * 8));
+                    std::vector chunks_sizes(size / grain_size, grain_size);
+                    if (size % grain_size != 0) {
+                        chunks_sizes.push_back(size % grain_size);
+                    }
+                    return chunks_sizes;
+                }
+                case chunking::guided: {
+                    std::size_t const min_chunk_size = std::max<std::size_t>(1, policy.grain_size);
+                    std::vector<std::size_t> chunks_sizes;
+                    for (std::size_t remaining = size; remaining != 0;) {
+                        std::size_t const chunk_size = std::min(remaining, std::max(min_chunk_size, (remaining + 2 * threads_count - 1) / (2 * threads_count)));
+                        chunks_sizes.push_back(chunk_size);
+                        remaining -= chunk_size;
+                    }
+                    return chunks_sizes;
+                }
+                default:
+                    return get_chunks_sizes(size, std::min(size, threads_count));
+            }
+        }
+
+        /**
+         * @brief returns the iterators which split [<b>it</b>, <b>end</b>) into the chunks of <b>chunks_sizes</b>,
+         * the last one is <b>end</b> converted to the iterator type
+         */
+        template <std::forward_iterator It, std::sentinel_for<It> Sent>
+        [[nodiscard]] std::vector<It> get_chunks_bounds(It it, Sent const & end, std::vector<std::size_t> const & chunks_sizes) {
+            std::vector<It> bounds;
+            bounds.reserve(chunks_sizes.size() + 1);
+            bounds.push_back(std::move(it));
+            for (std::size_t const chunk_size : chunks_sizes | std::views::take(chunks_sizes.size() - 1)) {
+                bounds.push_back(std::ranges::next(bounds.back(), chunk_size));
+            }
+            bounds.push_back(std::ranges::next(bounds.back(), end));
+
+            return bounds;
+        }
+
+        /**
+         * @brief invokes <b>fn</b> and returns its result if it is bool, false otherwise
+         */
+        template <typename Fn, typename... Args>
+        [[nodiscard]] bool invoke_stop_request(Fn & fn, Args &&... args) {
+            if constexpr (std::same_as<std::invoke_result_t<Fn &, Args...>, bool>) {
+                return std::invoke(fn, std::forward<Args>(args)...);
+            }
+            else {
+                std::invoke(fn, std::forward<Args>(args)...);
+                return false;
+            }
+        }
+
+        /**
+         * @brief invokes <b>fn</b> on the chunk [<b>beg</b>, <b>end</b>) with the stop source or token if it takes one
+         * @return true if the chunk asked to stop the others by returning true
+         */
+        template <typename Fn, typename It>
+        [[nodiscard]] bool invoke_chunk(Fn & fn, std::stop_source & stop_source, It beg, It end) {
+            if constexpr (std::invocable<Fn &, std::stop_source, It, It>) {
+                return invoke_stop_request(fn, stop_source, std::move(beg), std::move(end));
+            }
+            else if constexpr (std::invocable<Fn &, std::stop_token, It, It>) {
+                return invoke_stop_request(fn, stop_source.get_token(), std::move(beg), std::move(end));
+            }
+            else if constexpr (std::invocable<Fn &, It, It>) {
+                return invoke_stop_request(fn, std::move(beg), std::move(end));
+            }
+            else if constexpr (std::invocable<Fn &, std::stop_source, std::ranges::subrange<It>>) {
+                return invoke_stop_request(fn, stop_source, std::ranges::subrange(std::move(beg), std::move(end)));
+            }
+            else if constexpr (std::invocable<Fn &, std::stop_token, std::ranges::subrange<It>>) {
+                return invoke_stop_request(fn, stop_source.get_token(), std::ranges::subrange(std::move(beg), std::move(end)));
+            }
+            else {
+                return invoke_stop_request(fn, std::ranges::subrange(std::move(beg), std::move(end)));
+            }
+        }
+
+        /**
+         * @brief State of one fork-join call. Chunks are claimed by an atomic index, so the caller and the pool's workers
+         * run them in whatever order they come. The caller blocks on a latch counting finished chunks, not the helpers,
+         * so it completes all the chunks itself if the workers are busy. The helpers share the ownership of the state
+         * as they may still be checking for unclaimed chunks when the caller returns.
+         * All the chunks share one stop source, once a stop is requested the unclaimed chunks are skipped
+         */
+        template <typename It, typename Fn>
+        class fork_join_state {
+        public:
+            fork_join_state(std::vector<It> bounds, Fn const & fn) : m_bounds(std::move(bounds)), m_fn(fn), m_done(static_cast<std::ptrdiff_t>(chunks_count())) {}
+
+            /**
+             * @brief runs the unclaimed chunks until there are none left. An exception thrown by a chunk requests a stop
+             */
+            void run() noexcept {
+                for (std::size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < chunks_count(); i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+                    if (!m_stop_source.stop_requested()) {
+                        try {
+                            Fn fn = m_fn;
+                            if (invoke_chunk(fn, m_stop_source, m_bounds[i], m_bounds[i + 1])) {
+                                m_stop_source.request_stop();
+                            }
+                        }
+                        catch (...) {
+                            if (!m_has_exception.test_and_set(std::memory_order_relaxed)) {
+                                m_exception = std::current_exception();
+                            }
+                            m_stop_source.request_stop();
+                        }
+                    }
+                    m_done.count_down();
+                }
+            }
+
+            /**
+             * @brief waits until all the chunks are finished or skipped and rethrows the first exception thrown by them
+             */
+            void wait() {
+                m_done.wait();
+                if (m_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+            [[nodiscard]] std::size_t chunks_count() const noexcept {
+                return m_bounds.size() - 1;
+            }
+
+            [[nodiscard]] bool stop_requested() const noexcept {
+                return m_stop_source.stop_requested();
+            }
+
+        private:
+            std::vector<It> const m_bounds;
+            Fn const & m_fn;
+            std::latch m_done;
+            std::stop_source m_stop_source;
+            std::atomic<std::size_t> m_next = 0;
+            std::atomic_flag m_has_exception;
+            std::exception_ptr m_exception;
+        };
+
     }
 
+    /**
+     * @brief A pool of workers which fork-join algorithms can post their chunks to, e.g. eon::mt::thread_pool
+     */
+    template <typename Pool>
+    concept task_pool = requires(Pool & pool, std::vector<std::function<void()>> & tasks) {
+        { pool.size() } -> std::convertible_to<std::size_t>;
+        pool.post_bulk(tasks);
+    };
+
     template <typename Fn, typename It>
-    concept jthread_iter_invocable = std::input_or_output_iterator<It> && (std::invocable<Fn, It, It> || std::invocable<Fn, std::stop_token, It, It>);
+    concept jthread_iter_invocable = std::input_or_output_iterator<It> && (std::invocable<Fn, It, It> || std::invocable<Fn, std::stop_token, It, It>
+                                                                           || std::invocable<Fn, std::stop_source, It, It>);
 
     template <typename Fn, typename Rng>
-    concept jthread_range_invocable = std::ranges::range<Rng> && (std::invocable<Fn, Rng> || std::invocable<Fn, std::stop_token, Rng>);
+    concept jthread_range_invocable = std::ranges::range<Rng> && (std::invocable<Fn, Rng> || std::invocable<Fn, std::stop_token, Rng>
+                                                                  || std::invocable<Fn, std::stop_source, Rng>);
 
     template <typename Fn, typename It>
     concept jthread_invocable = jthread_iter_invocable<Fn, It> || jthread_range_invocable<Fn, std::ranges::subrange<It>>;
 
 
+    /**
+     * @brief Runs <b>fn</b> on chunks of <b>rng</b> on new threads and the calling thread.
+     * All the chunks of one call share a stop source: <b>fn</b> can take it (or its token) as the first argument,
+     * and a chunk stops the others by calling its request_stop() or by returning true. Once a stop is requested,
+     * the chunks which haven't started are skipped. The first exception thrown by <b>fn</b> requests a stop as well
+     * and is rethrown after all the chunks are finished
+     * @return true if the call was stopped
+     */
     template <std::ranges::forward_range Rng, jthread_invocable<std::ranges::iterator_t<Rng>> Fn>
-    void for_each_chunk(Rng && rng, Fn fn) {
+    bool for_each_chunk(Rng && rng, Fn fn, chunk_policy const policy = {}) {
+        using iter_t = std::ranges::iterator_t<Rng>;
+
         if (std::ranges::empty(rng)) {
-            return;
+            return false;
         }
 
         std::size_t const size = std::ranges::distance(rng);
@@ -44,46 +235,88 @@ namespace eon::mt {
             ++threads_count; // +1 for current thread
         }
 
-        std::vector<std::jthread> threads;
-        threads.reserve(threads_count);
-
-        auto it = std::ranges::begin(rng);
-        for (std::size_t const chunk_size : detail::get_chunks_sizes(size, threads_count) | std::views::take(threads_count - 1)) {
-            auto chunk_end = std::ranges::next(it, chunk_size);
-            if constexpr (jthread_iter_invocable<Fn, std::ranges::iterator_t<Rng>>) {
-                threads.emplace_back(fn, std::move(it), chunk_end);
-            }
-            else {
-                threads.emplace_back(fn, std::ranges::subrange(std::move(it), chunk_end));
+        detail::fork_join_state<iter_t, Fn> state(detail::get_chunks_bounds(std::ranges::begin(rng), std::ranges::end(rng),
+                                                                            detail::get_chunks_sizes(size, threads_count, policy)), fn);
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(threads_count - 1);
+            for (std::size_t i = 1; i < std::min(threads_count, state.chunks_count()); ++i) {
+                threads.emplace_back([&state] { state.run(); });
             }
-            it = std::move(chunk_end);
+            state.run();
         }
+        state.wait();
+
+        return state.stop_requested();
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, jthread_invocable<It> Fn>
+    bool for_each_chunk(It it, Sent sent, Fn fn, chunk_policy const policy = {}) {
+        return for_each_chunk(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), policy);
+    }
+
+    /**
+     * @brief Runs <b>fn</b> on chunks of <b>rng</b> on the workers of <b>pool</b> and the calling thread,
+     * which blocks until all the chunks are finished. Doesn't create threads, so it is cheap to call often.
+     * Stopping and exceptions work as in for_each_chunk(rng, fn, policy).
+     * Use eon::mt::default_pool() from thread_pool.hpp for the process-wide pool
+     * @return true if the call was stopped
+     */
+    template <task_pool Pool, std::ranges::forward_range Rng, jthread_invocable<std::ranges::iterator_t<Rng>> Fn>
+    bool for_each_chunk(Pool & pool, Rng && rng, Fn fn, chunk_policy const policy = {}) {
+        using iter_t = std::ranges::iterator_t<Rng>;
 
-        auto end = std::ranges::next(it, std::ranges::end(rng));
-        if constexpr (jthread_iter_invocable<Fn, std::ranges::iterator_t<Rng>>) {
-            std::invoke(fn, std::move(it), std::move(end));
+        if (std::ranges::empty(rng)) {
+            return false;
         }
-        else {
-            std::invoke(fn, std::ranges::subrange(std::move(it), std::move(end)));
+
+        std::size_t const size = std::ranges::distance(rng);
+        std::size_t const threads_count = pool.size() + 1; // +1 for current thread
+
+        auto const state = std::make_shared<detail::fork_join_state<iter_t, Fn>>(
+                detail::get_chunks_bounds(std::ranges::begin(rng), std::ranges::end(rng), detail::get_chunks_sizes(size, threads_count, policy)), fn);
+
+        std::size_t const helpers_count = std::min(threads_count, state->chunks_count()) - 1;
+        if (helpers_count != 0) {
+            pool.post_bulk(std::views::iota(std::size_t{0}, helpers_count) | std::views::transform([&state](std::size_t) {
+                return [state] { state->run(); };
+            }));
         }
+
+        state->run();
+        state->wait();
+
+        return state->stop_requested();
     }
 
-    template <std::forward_iterator It, std::sentinel_for<It> Sent, jthread_invocable<It> Fn>
-    void for_each_chunk(It it, Sent sent, Fn fn) {
-        for_each_chunk(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn));
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, jthread_invocable<It> Fn>
+    bool for_each_chunk(Pool & pool, It it, Sent sent, Fn fn, chunk_policy const policy = {}) {
+        return mt::for_each_chunk(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), policy);
     }
 
 
     template <std::ranges::forward_range Rng, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> Fn>
-    void for_each(Rng && rng, Fn fn) {
+    void for_each(Rng && rng, Fn fn, chunk_policy const policy = {}) {
         for_each_chunk(std::forward<Rng>(rng), [&](auto beg, auto end) {
             std::ranges::for_each(std::move(beg), std::move(end), fn);
-        });
+        }, policy);
     }
 
     template <std::forward_iterator It, std::sentinel_for<It> Sent, std::indirectly_unary_invocable<It> Fn>
-    void for_each(It it, Sent sent, Fn fn) {
-        mt::for_each(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn));
+    void for_each(It it, Sent sent, Fn fn, chunk_policy const policy = {}) {
+        mt::for_each(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), policy);
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> Fn>
+    void for_each(Pool & pool, Rng && rng, Fn fn, chunk_policy const policy = {}) {
+        mt::for_each_chunk(pool, std::forward<Rng>(rng), [&](auto beg, auto end) {
+            std::ranges::for_each(std::move(beg), std::move(end), fn);
+        }, policy);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::indirectly_unary_invocable<It> Fn>
+    void for_each(Pool & pool, It it, Sent sent, Fn fn, chunk_policy const policy = {}) {
+        mt::for_each(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), policy);
     }
 
     template <typename ExecPolicy, std::ranges::forward_range Rng, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> Fn>
@@ -100,12 +333,31 @@ namespace eon::mt {
     }
 
 
+    namespace detail {
+
+        /**
+         * @brief result of <b>fn</b> called on a chunk, as a pair of iterators if it accepts them or as a subrange
+         */
+        template <typename Fn, typename It>
+        struct chunk_result {
+            using type = std::invoke_result_t<Fn, std::ranges::subrange<It>>;
+        };
+
+        template <typename Fn, typename It>
+        requires (jthread_iter_invocable<Fn, It>)
+        struct chunk_result<Fn, It> {
+            using type = std::invoke_result_t<Fn, It, It>;
+        };
+
+        template <typename Fn, typename It>
+        using chunk_result_t = typename chunk_result<Fn, It>::type;
+
+    }
+
     template <std::ranges::forward_range Rng, jthread_invocable<std::ranges::iterator_t<Rng>> Fn>
     [[nodiscard]] auto for_each_chunk_async(Rng && rng, Fn fn, std::launch policy = std::launch::async | std::launch::deferred) {
         using iter_t = std::ranges::iterator_t<Rng>;
-        using result_t = std::conditional_t<jthread_iter_invocable<Fn, iter_t>,
-                                            std::invoke_result_t<Fn, iter_t, iter_t>,
-                                            std::invoke_result_t<Fn, std::ranges::subrange<iter_t>>>;
+        using result_t = detail::chunk_result_t<Fn, iter_t>;
 
         using futures_container_t = std::vector<std::future<result_t>>;
 
@@ -165,4 +417,657 @@ namespace eon::mt {
     [[nodiscard]] auto for_each_async(It it, Sent sent, Fn fn, std::launch policy = std::launch::async | std::launch::deferred) {
         return for_each_async(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), policy);
     }
+
+    /**
+     * @brief Posts <b>fn</b> on chunks of <b>rng</b> to <b>pool</b>, one chunk per worker.
+     * Returns eon::mt::future's, which can be chained with then() and combined with when_all() and when_any()
+     */
+    template <task_pool Pool, std::ranges::forward_range Rng, jthread_invocable<std::ranges::iterator_t<Rng>> Fn>
+    requires (scheduler<Pool>)
+    [[nodiscard]] auto for_each_chunk_async(Pool & pool, Rng && rng, Fn fn) {
+        using iter_t = std::ranges::iterator_t<Rng>;
+        using result_t = detail::chunk_result_t<Fn, iter_t>;
+
+        std::vector<future<result_t>> futures;
+        if (std::ranges::empty(rng)) {
+            return futures;
+        }
+
+        std::size_t const size = std::ranges::distance(rng);
+        auto const bounds = detail::get_chunks_bounds(std::ranges::begin(rng), std::ranges::end(rng),
+                                                      detail::get_chunks_sizes(size, std::min<std::size_t>(size, std::max<std::size_t>(pool.size(), 1))));
+
+        futures.reserve(bounds.size() - 1);
+        for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+            promise<result_t> promise;
+            futures.push_back(promise.get_future());
+            pool.post([promise = std::move(promise), fn, beg = bounds[i], end = bounds[i + 1]]() mutable {
+                auto call = [&] {
+                    if constexpr (jthread_iter_invocable<Fn, iter_t>) {
+                        return std::invoke(fn, std::move(beg), std::move(end));
+                    }
+                    else {
+                        return std::invoke(fn, std::ranges::subrange(std::move(beg), std::move(end)));
+                    }
+                };
+                detail::invoke_into(promise, call);
+            });
+        }
+
+        return futures;
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, jthread_invocable<It> Fn>
+    requires (scheduler<Pool>)
+    [[nodiscard]] auto for_each_chunk_async(Pool & pool, It it, Sent sent, Fn fn) {
+        return for_each_chunk_async(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn));
+    }
+
+
+    namespace detail {
+
+        /**
+         * @brief State of a bounded for_each_async. A fixed number of runners take the elements one by one in order
+         * and fulfil their promises, whose shared states come from a slab allocator
+         */
+        template <std::ranges::view View, typename Fn>
+        class async_loop_state {
+            using iter_t = std::ranges::iterator_t<View>;
+
+        public:
+            using result_t = std::indirect_result_t<Fn &, iter_t>;
+
+            async_loop_state(View view, Fn fn) : m_view(std::move(view)), m_fn(std::move(fn)), m_begin(std::ranges::begin(m_view)), m_cursor(m_begin) {
+                if constexpr (std::ranges::sized_range<View>) {
+                    m_promises.reserve(std::ranges::size(m_view));
+                }
+                for (auto it = m_begin; it != std::ranges::end(m_view); ++it) {
+                    m_promises.emplace_back(*m_allocator);
+                }
+            }
+
+            [[nodiscard]] std::vector<future<result_t>> get_futures() {
+                std::vector<future<result_t>> futures;
+                futures.reserve(m_promises.size());
+                for (promise<result_t> & promise : m_promises) {
+                    futures.push_back(promise.get_future());
+                }
+                return futures;
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return m_promises.size();
+            }
+
+            /**
+             * @brief processes the elements until there are no unclaimed ones left
+             */
+            void run() {
+                Fn fn = m_fn;
+                iter_t it;
+                std::size_t index;
+                while (claim(it, index)) {
+                    auto call = [&fn, &it]() -> result_t { return std::invoke(fn, *it); };
+                    invoke_into(m_promises[index], call);
+                }
+            }
+
+        private:
+            [[nodiscard]] bool claim(iter_t & it, std::size_t & index) {
+                if constexpr (std::random_access_iterator<iter_t>) {
+                    index = m_next.fetch_add(1, std::memory_order_relaxed);
+                    if (index >= m_promises.size()) {
+                        return false;
+                    }
+                    it = m_begin + static_cast<std::iter_difference_t<iter_t>>(index);
+                }
+                else {
+                    std::scoped_lock lock(m_cursor_mutex);
+                    if (m_next.load(std::memory_order_relaxed) == m_promises.size()) {
+                        return false;
+                    }
+                    index = m_next.fetch_add(1, std::memory_order_relaxed);
+                    it = m_cursor++;
+                }
+                return true;
+            }
+
+        private:
+            slab_allocator::handle m_allocator = slab_allocator::make();
+            View m_view;
+            Fn const m_fn;
+            iter_t const m_begin;
+            std::vector<promise<result_t>> m_promises;
+            std::atomic<std::size_t> m_next = 0;
+
+            std::mutex m_cursor_mutex; // guards m_cursor for non random access iterators
+            iter_t m_cursor;
+        };
+
+        /**
+         * @brief creates the state of a bounded for_each_async and passes up to <b>max_in_flight</b> of its runners to <b>launch</b>
+         */
+        template <std::ranges::forward_range Rng, typename Fn, typename Launch>
+        [[nodiscard]] auto launch_async_loop(Rng && rng, Fn fn, std::size_t const max_in_flight, Launch launch) {
+            using state_t = async_loop_state<std::views::all_t<Rng>, Fn>;
+
+            auto const state = std::make_shared<state_t>(std::views::all(std::forward<Rng>(rng)), std::move(fn));
+            auto futures = state->get_futures();
+            std::size_t const runners_count = std::min(state->size(), std::max<std::size_t>(max_in_flight, 1));
+            for (std::size_t i = 0; i < runners_count; ++i) {
+                launch([state] { state->run(); });
+            }
+
+            return futures;
+        }
+
+        /**
+         * @brief Threads of a bounded for_each_async co-owned by its futures, the last future joins them like a std::async future.
+         * A thread which drops the last future itself (e.g. in a continuation) can't join itself, so it's detached
+         * and finishes the loop on its own
+         */
+        class async_loop_threads {
+        public:
+            async_loop_threads() = default;
+
+            async_loop_threads(async_loop_threads const &) = delete;
+            async_loop_threads & operator=(async_loop_threads const &) = delete;
+
+            ~async_loop_threads() {
+                for (std::jthread & thread : m_threads) {
+                    if (thread.get_id() == std::this_thread::get_id()) {
+                        thread.detach();
+                    }
+                }
+            }
+
+            template <typename Runner>
+            void start(Runner runner) {
+                m_threads.emplace_back(std::move(runner));
+            }
+
+        private:
+            std::vector<std::jthread> m_threads;
+        };
+
+    }
+
+    /**
+     * @brief Calls <b>fn</b> on every element of <b>rng</b> on at most <b>max_in_flight</b> new threads, which take the elements in order.
+     * The number of threads doesn't depend on the size of <b>rng</b> and the futures' shared states come from one slab allocator,
+     * so memory use is a few words per element. An rvalue <b>rng</b> is kept alive until all the elements are processed.
+     * Like std::async futures, the futures join the threads once all of them are destroyed
+     */
+    template <std::ranges::forward_range Rng, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> Fn>
+    requires (std::ranges::viewable_range<Rng>)
+    [[nodiscard]] auto for_each_async(Rng && rng, Fn fn, std::size_t max_in_flight) {
+        auto const threads = std::make_shared<detail::async_loop_threads>();
+        auto futures = detail::launch_async_loop(std::forward<Rng>(rng), std::move(fn), max_in_flight, [&threads](auto runner) {
+            threads->start(std::move(runner));
+        });
+
+        for (auto & future : futures) {
+            detail::future_combinators::attach_owner(future, threads);
+        }
+        return futures;
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::indirectly_unary_invocable<It> Fn>
+    [[nodiscard]] auto for_each_async(It it, Sent sent, Fn fn, std::size_t max_in_flight) {
+        return for_each_async(std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), max_in_flight);
+    }
+
+    /**
+     * @brief Calls <b>fn</b> on every element of <b>rng</b> on the workers of <b>pool</b>.
+     * Like the overload with <b>max_in_flight</b>, but the runners are posted to <b>pool</b>, by default one per worker,
+     * so the pool's queue holds a few tasks whatever the size of <b>rng</b>.
+     * Returns eon::mt::future's, which can be chained with then() and combined with when_all() and when_any()
+     */
+    template <task_pool Pool, std::ranges::forward_range Rng, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> Fn>
+    requires (scheduler<Pool> && std::ranges::viewable_range<Rng>)
+    [[nodiscard]] auto for_each_async(Pool & pool, Rng && rng, Fn fn, std::size_t max_in_flight = 0) {
+        return detail::launch_async_loop(std::forward<Rng>(rng), std::move(fn), max_in_flight != 0 ? max_in_flight : pool.size(), [&pool](auto runner) {
+            pool.post(std::move(runner));
+        });
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::indirectly_unary_invocable<It> Fn>
+    requires (scheduler<Pool>)
+    [[nodiscard]] auto for_each_async(Pool & pool, It it, Sent sent, Fn fn, std::size_t max_in_flight = 0) {
+        return for_each_async(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(fn), max_in_flight);
+    }
+
+    namespace detail {
+
+        template <typename... Pool>
+        [[nodiscard]] std::size_t threads_count(Pool &... pool) {
+            if constexpr (sizeof...(Pool) == 0) {
+                return concurrent_available();
+            }
+            else {
+                return (pool.size(), ...) + 1; // +1 for current thread
+            }
+        }
+
+        /**
+         * @brief returns the bounds of one equal chunk per thread, a non-empty <b>rng</b> gives only non-empty chunks
+         */
+        template <std::ranges::forward_range Rng, typename... Pool>
+        [[nodiscard]] std::vector<std::ranges::iterator_t<Rng>> split(Rng & rng, Pool &... pool) {
+            std::size_t const size = std::ranges::distance(rng);
+            return get_chunks_bounds(std::ranges::begin(rng), std::ranges::end(rng), get_chunks_sizes(size, std::min(size, threads_count(pool...))));
+        }
+
+        /**
+         * @brief calls <b>fn(i)</b> for every i in [0, <b>count</b>) in parallel, the indices are claimed in ascending order
+         */
+        template <typename Fn, typename... Pool>
+        void for_each_index(std::size_t const count, Fn fn, Pool &... pool) {
+            mt::for_each_chunk(pool..., std::views::iota(std::size_t{0}, count), [&fn](auto beg, auto end) {
+                for (; beg != end; ++beg) {
+                    fn(*beg);
+                }
+            }, chunk_policy{chunking::dynamic, 1});
+        }
+
+        template <typename Rng, typename T, typename ReduceOp, typename TransformOp, typename... Pool>
+        [[nodiscard]] T transform_reduce(Rng && rng, T init, ReduceOp reduce_op, TransformOp transform_op, Pool &... pool) {
+            if (std::ranges::empty(rng)) {
+                return init;
+            }
+
+            auto const bounds = split(rng, pool...);
+            std::vector<padded<std::optional<T>>> partials(bounds.size() - 1);
+
+            for_each_index(partials.size(), [&](std::size_t const i) {
+                auto it = bounds[i];
+                T value = std::invoke(transform_op, *it);
+                for (++it; it != bounds[i + 1]; ++it) {
+                    value = std::invoke(reduce_op, std::move(value), std::invoke(transform_op, *it));
+                }
+                partials[i].value.emplace(std::move(value));
+            }, pool...);
+
+            for (auto & partial : partials) {
+                init = std::invoke(reduce_op, std::move(init), std::move(*partial.value));
+            }
+            return init;
+        }
+
+        /**
+         * @brief scans the chunks in two passes: the sums of the chunks, then the chunks themselves starting from the sums of the previous ones.
+         * The exclusive scan starts from <b>init</b>
+         */
+        template <bool Inclusive, typename Rng, typename Out, typename T, typename Op, typename... Pool>
+        Out scan(Rng && rng, Out out, std::optional<T> init, Op op, Pool &... pool) {
+            if (std::ranges::empty(rng)) {
+                return out;
+            }
+
+            auto const bounds = split(rng, pool...);
+            std::size_t const chunks_count = bounds.size() - 1;
+
+            std::vector<padded<std::optional<T>>> sums(chunks_count);
+            for_each_index(chunks_count - 1, [&](std::size_t const i) {
+                auto it = bounds[i];
+                T sum = *it;
+                for (++it; it != bounds[i + 1]; ++it) {
+                    sum = std::invoke(op, std::move(sum), *it);
+                }
+                sums[i].value.emplace(std::move(sum));
+            }, pool...);
+
+            std::vector<std::optional<T>> carries(chunks_count);
+            std::vector<Out> outs{out};
+            outs.reserve(chunks_count + 1);
+            carries[0] = std::move(init);
+            for (std::size_t i = 0; i < chunks_count; ++i) {
+                if (i + 1 < chunks_count) {
+                    carries[i + 1] = carries[i] ? std::invoke(op, *carries[i], std::move(*sums[i].value)) : std::move(*sums[i].value);
+                }
+                outs.push_back(std::ranges::next(outs.back(), std::ranges::distance(bounds[i], bounds[i + 1])));
+            }
+
+            for_each_index(chunks_count, [&](std::size_t const i) {
+                std::optional<T> & carry = carries[i];
+                auto dest = outs[i];
+                for (auto it = bounds[i]; it != bounds[i + 1]; ++it, ++dest) {
+                    if constexpr (Inclusive) {
+                        carry = carry ? std::invoke(op, std::move(*carry), *it) : T(*it);
+                        *dest = *carry;
+                    }
+                    else {
+                        T value = *it; // the output may alias the input
+                        *dest = *carry;
+                        carry = std::invoke(op, std::move(*carry), std::move(value));
+                    }
+                }
+            }, pool...);
+
+            return outs.back();
+        }
+
+        /**
+         * @brief lowers <b>index</b> to <b>i</b> if it is greater
+         */
+        inline void lower_index(std::atomic<std::size_t> & index, std::size_t const i) noexcept {
+            std::size_t expected = index.load(std::memory_order_relaxed);
+            while (expected > i && !index.compare_exchange_weak(expected, i, std::memory_order_relaxed)) {}
+        }
+
+        /**
+         * @brief searches small chunks claimed in ascending order, a match stops the chunks after it and a stop request
+         * through <b>stop_token</b> stops them all. The chunks' shared stop source isn't used: it would skip chunks claimed
+         * but not started yet, which may come before the match
+         */
+        template <typename Rng, typename Pred, typename... Pool>
+        [[nodiscard]] std::ranges::iterator_t<Rng> find_if(Rng && rng, Pred pred, std::stop_token const & stop_token, Pool &... pool) {
+            if (std::ranges::empty(rng)) {
+                return std::ranges::next(std::ranges::begin(rng), std::ranges::end(rng));
+            }
+
+            std::size_t const size = std::ranges::distance(rng);
+            auto const bounds = get_chunks_bounds(std::ranges::begin(rng), std::ranges::end(rng),
+                                                  get_chunks_sizes(size, threads_count(pool...), {chunking::dynamic}));
+            std::size_t const chunks_count = bounds.size() - 1;
+
+            std::atomic<std::size_t> found = chunks_count;      // the first chunk with a match
+            std::atomic<std::size_t> cancelled = chunks_count;  // the first chunk given up on a stop request
+            std::vector<std::ranges::iterator_t<Rng>> matches(chunks_count);
+
+            for_each_index(chunks_count, [&](std::size_t const i) {
+                for (auto it = bounds[i]; it != bounds[i + 1] && found.load(std::memory_order_relaxed) > i; ++it) {
+                    if (stop_token.stop_requested()) {
+                        lower_index(cancelled, i);
+                        return;
+                    }
+                    if (std::invoke(pred, *it)) {
+                        matches[i] = it;
+                        lower_index(found, i);
+                        return;
+                    }
+                }
+            }, pool...);
+
+            std::size_t const index = found.load(std::memory_order_relaxed);
+            return index == chunks_count || cancelled.load(std::memory_order_relaxed) < index ? bounds.back() : matches[index];
+        }
+
+        /**
+         * @brief sorts the chunks in parallel, then merges them pairwise in log2(chunks) parallel rounds
+         */
+        template <typename Rng, typename Comp, typename... Pool>
+        void sort(Rng && rng, Comp comp, Pool &... pool) {
+            if (std::ranges::empty(rng)) {
+                return;
+            }
+
+            auto const bounds = split(rng, pool...);
+            std::size_t const chunks_count = bounds.size() - 1;
+
+            for_each_index(chunks_count, [&](std::size_t const i) {
+                std::sort(bounds[i], bounds[i + 1], std::ref(comp));
+            }, pool...);
+
+            for (std::size_t width = 1; width < chunks_count; width *= 2) {
+                for_each_index((chunks_count + 2 * width - 1) / (2 * width), [&](std::size_t const i) {
+                    std::size_t const first = 2 * width * i;
+                    std::size_t const middle = std::min(first + width, chunks_count);
+                    std::size_t const last = std::min(first + 2 * width, chunks_count);
+                    std::inplace_merge(bounds[first], bounds[middle], bounds[last], std::ref(comp));
+                }, pool...);
+            }
+        }
+
+        /**
+         * @brief partitions the chunks in parallel, then joins them pairwise in log2(chunks) parallel rounds
+         * by rotating the second group of the left chunk with the first group of the right one
+         */
+        template <typename Rng, typename Pred, typename... Pool>
+        [[nodiscard]] std::ranges::iterator_t<Rng> partition(Rng && rng, Pred pred, Pool &... pool) {
+            if (std::ranges::empty(rng)) {
+                return std::ranges::next(std::ranges::begin(rng), std::ranges::end(rng));
+            }
+
+            auto const bounds = split(rng, pool...);
+            std::size_t const chunks_count = bounds.size() - 1;
+            std::vector<std::ranges::iterator_t<Rng>> middles(chunks_count);
+
+            for_each_index(chunks_count, [&](std::size_t const i) {
+                middles[i] = std::partition(bounds[i], bounds[i + 1], std::ref(pred));
+            }, pool...);
+
+            for (std::size_t width = 1; width < chunks_count; width *= 2) {
+                for_each_index((chunks_count + 2 * width - 1) / (2 * width), [&](std::size_t const i) {
+                    std::size_t const left = 2 * width * i;
+                    std::size_t const right = left + width;
+                    if (right < chunks_count) {
+                        middles[left] = std::rotate(middles[left], bounds[right], middles[right]);
+                    }
+                }, pool...);
+            }
+
+            return middles[0];
+        }
+
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::reduce</b>, <b>op</b> must be associative.
+     * The elements of a chunk are reduced in order and the results of the chunks are combined in order
+     */
+    template <std::ranges::forward_range Rng, typename T, typename Op = std::plus<>>
+    requires (std::invocable<Op &, T, std::ranges::range_reference_t<Rng>>)
+    [[nodiscard]] T reduce(Rng && rng, T init, Op op = {}) {
+        return detail::transform_reduce(rng, std::move(init), std::move(op), std::identity{});
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, typename T, typename Op = std::plus<>>
+    requires (std::invocable<Op &, T, std::iter_reference_t<It>>)
+    [[nodiscard]] T reduce(It it, Sent sent, T init, Op op = {}) {
+        return mt::reduce(std::ranges::subrange(std::move(it), std::move(sent)), std::move(init), std::move(op));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, typename T, typename Op = std::plus<>>
+    requires (std::invocable<Op &, T, std::ranges::range_reference_t<Rng>>)
+    [[nodiscard]] T reduce(Pool & pool, Rng && rng, T init, Op op = {}) {
+        return detail::transform_reduce(rng, std::move(init), std::move(op), std::identity{}, pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, typename T, typename Op = std::plus<>>
+    requires (std::invocable<Op &, T, std::iter_reference_t<It>>)
+    [[nodiscard]] T reduce(Pool & pool, It it, Sent sent, T init, Op op = {}) {
+        return mt::reduce(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(init), std::move(op));
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::transform_reduce</b>, <b>reduce_op</b> must be associative
+     */
+    template <std::ranges::forward_range Rng, typename T, typename ReduceOp, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> TransformOp>
+    [[nodiscard]] T transform_reduce(Rng && rng, T init, ReduceOp reduce_op, TransformOp transform_op) {
+        return detail::transform_reduce(rng, std::move(init), std::move(reduce_op), std::move(transform_op));
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, typename T, typename ReduceOp, std::indirectly_unary_invocable<It> TransformOp>
+    [[nodiscard]] T transform_reduce(It it, Sent sent, T init, ReduceOp reduce_op, TransformOp transform_op) {
+        return mt::transform_reduce(std::ranges::subrange(std::move(it), std::move(sent)), std::move(init), std::move(reduce_op), std::move(transform_op));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, typename T, typename ReduceOp, std::indirectly_unary_invocable<std::ranges::iterator_t<Rng>> TransformOp>
+    [[nodiscard]] T transform_reduce(Pool & pool, Rng && rng, T init, ReduceOp reduce_op, TransformOp transform_op) {
+        return detail::transform_reduce(rng, std::move(init), std::move(reduce_op), std::move(transform_op), pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, typename T, typename ReduceOp, std::indirectly_unary_invocable<It> TransformOp>
+    [[nodiscard]] T transform_reduce(Pool & pool, It it, Sent sent, T init, ReduceOp reduce_op, TransformOp transform_op) {
+        return mt::transform_reduce(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(init), std::move(reduce_op), std::move(transform_op));
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::inclusive_scan</b>, <b>op</b> must be associative. <b>out</b> may be the beginning of <b>rng</b>
+     * @return the end of the output range
+     */
+    template <std::ranges::forward_range Rng, std::forward_iterator Out, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, std::ranges::range_value_t<Rng>>)
+    Out inclusive_scan(Rng && rng, Out out, Op op = {}) {
+        return detail::scan<true>(rng, std::move(out), std::optional<std::ranges::range_value_t<Rng>>{}, std::move(op));
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::forward_iterator Out, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, std::iter_value_t<It>>)
+    Out inclusive_scan(It it, Sent sent, Out out, Op op = {}) {
+        return mt::inclusive_scan(std::ranges::subrange(std::move(it), std::move(sent)), std::move(out), std::move(op));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::forward_iterator Out, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, std::ranges::range_value_t<Rng>>)
+    Out inclusive_scan(Pool & pool, Rng && rng, Out out, Op op = {}) {
+        return detail::scan<true>(rng, std::move(out), std::optional<std::ranges::range_value_t<Rng>>{}, std::move(op), pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::forward_iterator Out, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, std::iter_value_t<It>>)
+    Out inclusive_scan(Pool & pool, It it, Sent sent, Out out, Op op = {}) {
+        return mt::inclusive_scan(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(out), std::move(op));
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::exclusive_scan</b>, <b>op</b> must be associative. <b>out</b> may be the beginning of <b>rng</b>
+     * @return the end of the output range
+     */
+    template <std::ranges::forward_range Rng, std::forward_iterator Out, typename T, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, T>)
+    Out exclusive_scan(Rng && rng, Out out, T init, Op op = {}) {
+        return detail::scan<false>(rng, std::move(out), std::optional<T>(std::move(init)), std::move(op));
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::forward_iterator Out, typename T, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, T>)
+    Out exclusive_scan(It it, Sent sent, Out out, T init, Op op = {}) {
+        return mt::exclusive_scan(std::ranges::subrange(std::move(it), std::move(sent)), std::move(out), std::move(init), std::move(op));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::forward_iterator Out, typename T, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, T>)
+    Out exclusive_scan(Pool & pool, Rng && rng, Out out, T init, Op op = {}) {
+        return detail::scan<false>(rng, std::move(out), std::optional<T>(std::move(init)), std::move(op), pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::forward_iterator Out, typename T, typename Op = std::plus<>>
+    requires (std::indirectly_writable<Out, T>)
+    Out exclusive_scan(Pool & pool, It it, Sent sent, Out out, T init, Op op = {}) {
+        return mt::exclusive_scan(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(out), std::move(init), std::move(op));
+    }
+
+
+    template <std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    [[nodiscard]] std::ranges::range_difference_t<Rng> count_if(Rng && rng, Pred pred) {
+        return detail::transform_reduce(rng, std::ranges::range_difference_t<Rng>{0}, std::plus<>{}, [&pred](auto && value) {
+            return static_cast<std::ranges::range_difference_t<Rng>>(std::invoke(pred, value) ? 1 : 0);
+        });
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    [[nodiscard]] std::iter_difference_t<It> count_if(It it, Sent sent, Pred pred) {
+        return mt::count_if(std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    [[nodiscard]] std::ranges::range_difference_t<Rng> count_if(Pool & pool, Rng && rng, Pred pred) {
+        return detail::transform_reduce(rng, std::ranges::range_difference_t<Rng>{0}, std::plus<>{}, [&pred](auto && value) {
+            return static_cast<std::ranges::range_difference_t<Rng>>(std::invoke(pred, value) ? 1 : 0);
+        }, pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    [[nodiscard]] std::iter_difference_t<It> count_if(Pool & pool, It it, Sent sent, Pred pred) {
+        return mt::count_if(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred));
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::find_if</b>, returns the first element satisfying <b>pred</b>.
+     * Once a match is found, the chunks after it stop early. A stop requested through <b>stop_token</b> cancels the search,
+     * which then returns the end of the range unless the first match has already been found
+     */
+    template <std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    [[nodiscard]] std::ranges::borrowed_iterator_t<Rng> find_if(Rng && rng, Pred pred, std::stop_token const & stop_token = {}) {
+        return detail::find_if(rng, std::move(pred), stop_token);
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    [[nodiscard]] It find_if(It it, Sent sent, Pred pred, std::stop_token const & stop_token = {}) {
+        return mt::find_if(std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred), stop_token);
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    [[nodiscard]] std::ranges::borrowed_iterator_t<Rng> find_if(Pool & pool, Rng && rng, Pred pred, std::stop_token const & stop_token = {}) {
+        return detail::find_if(rng, std::move(pred), stop_token, pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    [[nodiscard]] It find_if(Pool & pool, It it, Sent sent, Pred pred, std::stop_token const & stop_token = {}) {
+        return mt::find_if(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred), stop_token);
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::sort</b>, not stable
+     */
+    template <std::ranges::random_access_range Rng, typename Comp = std::ranges::less>
+    requires (std::sortable<std::ranges::iterator_t<Rng>, Comp>)
+    void sort(Rng && rng, Comp comp = {}) {
+        detail::sort(rng, std::move(comp));
+    }
+
+    template <std::random_access_iterator It, std::sentinel_for<It> Sent, typename Comp = std::ranges::less>
+    requires (std::sortable<It, Comp>)
+    void sort(It it, Sent sent, Comp comp = {}) {
+        mt::sort(std::ranges::subrange(std::move(it), std::move(sent)), std::move(comp));
+    }
+
+    template <task_pool Pool, std::ranges::random_access_range Rng, typename Comp = std::ranges::less>
+    requires (std::sortable<std::ranges::iterator_t<Rng>, Comp>)
+    void sort(Pool & pool, Rng && rng, Comp comp = {}) {
+        detail::sort(rng, std::move(comp), pool);
+    }
+
+    template <task_pool Pool, std::random_access_iterator It, std::sentinel_for<It> Sent, typename Comp = std::ranges::less>
+    requires (std::sortable<It, Comp>)
+    void sort(Pool & pool, It it, Sent sent, Comp comp = {}) {
+        mt::sort(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(comp));
+    }
+
+
+    /**
+     * @brief Parallel analogue of <b>std::partition</b>, not stable
+     * @return the beginning of the elements not satisfying <b>pred</b>
+     */
+    template <std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    requires (std::permutable<std::ranges::iterator_t<Rng>>)
+    std::ranges::borrowed_iterator_t<Rng> partition(Rng && rng, Pred pred) {
+        return detail::partition(rng, std::move(pred));
+    }
+
+    template <std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    requires (std::permutable<It>)
+    It partition(It it, Sent sent, Pred pred) {
+        return mt::partition(std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred));
+    }
+
+    template <task_pool Pool, std::ranges::forward_range Rng, std::indirect_unary_predicate<std::ranges::iterator_t<Rng>> Pred>
+    requires (std::permutable<std::ranges::iterator_t<Rng>>)
+    std::ranges::borrowed_iterator_t<Rng> partition(Pool & pool, Rng && rng, Pred pred) {
+        return detail::partition(rng, std::move(pred), pool);
+    }
+
+    template <task_pool Pool, std::forward_iterator It, std::sentinel_for<It> Sent, std::indirect_unary_predicate<It> Pred>
+    requires (std::permutable<It>)
+    It partition(Pool & pool, It it, Sent sent, Pred pred) {
+        return mt::partition(pool, std::ranges::subrange(std::move(it), std::move(sent)), std::move(pred));
+    }
 }
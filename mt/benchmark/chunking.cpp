@@ -0,0 +1,52 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <numeric>
+
+#include <eon/mt.hpp>
+#include <eon/chrono.hpp>
+
+// Measures for_each over a deliberately imbalanced workload: the cost of an element grows quadratically
+// with its index, so with the equal split the thread which gets the last chunk sets the time of the whole call
+
+constexpr std::size_t elements_count = 1 << 12;
+constexpr std::size_t repeats_count = 8;
+
+[[nodiscard]] double work(std::size_t const index) {
+    std::size_t const iterations = index * index / elements_count;
+    double value = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        value += std::sqrt(static_cast<double>(i + index));
+    }
+    return value;
+}
+
+template <typename... Pool>
+[[nodiscard]] double seconds(eon::mt::chunk_policy const policy, Pool &... pool) {
+    std::vector<std::size_t> indices(elements_count);
+    std::iota(indices.begin(), indices.end(), std::size_t{0});
+    std::vector<double> results(elements_count);
+
+    eon::chrono::timer const timer;
+    for (std::size_t i = 0; i < repeats_count; ++i) {
+        eon::mt::for_each(pool..., indices, [&](std::size_t const index) {
+            results[index] = work(index);
+        }, policy);
+    }
+
+    return timer.elapsed() / repeats_count;
+}
+
+int main() {
+    eon::mt::thread_pool<> thread_pool(eon::mt::concurrent_available() - 1);
+
+    std::cout << "chunking | new threads, s | thread_pool, s\n";
+
+    for (auto const & [name, policy] : {std::pair{"equal", eon::mt::chunk_policy{eon::mt::chunking::equal}},
+                                        std::pair{"dynamic", eon::mt::chunk_policy{eon::mt::chunking::dynamic}},
+                                        std::pair{"guided", eon::mt::chunk_policy{eon::mt::chunking::guided}}}) {
+        std::cout << name << " | " << seconds(policy) << " | " << seconds(policy, thread_pool) << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <vector>
+#include <latch>
+#include <mutex>
+#include <shared_mutex>
+
+#include <eon/mt.hpp>
+#include <eon/chrono.hpp>
+
+// Measures lock throughput under contention: every thread repeatedly takes the lock around a short critical section.
+// The exclusive test only writes, the read-mostly test writes once per read_share operations and reads otherwise.
+// The transfers test locks pairs of accounts picked in opposite orders by different threads
+
+constexpr std::size_t operations_count = 1 << 20;
+constexpr std::size_t read_share = 32;
+constexpr std::size_t accounts_count = 8;
+
+struct shared_data {
+    std::size_t values[8]{};
+};
+
+template <typename Mutex, typename Operation>
+[[nodiscard]] double operations_per_second(std::size_t const threads_count, Operation operation) {
+    Mutex mutex;
+    shared_data data;
+    std::size_t const operations_per_thread = operations_count / threads_count;
+    std::latch start(static_cast<std::ptrdiff_t>(threads_count) + 1);
+
+    std::vector<std::jthread> threads;
+    threads.reserve(threads_count);
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&] {
+            start.arrive_and_wait();
+            for (std::size_t j = 0; j < operations_per_thread; ++j) {
+                operation(mutex, data, j);
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    eon::chrono::timer const timer;
+    threads.clear();
+
+    return static_cast<double>(operations_per_thread * threads_count) / timer.elapsed();
+}
+
+void write(auto & mutex, shared_data & data) {
+    eon::mt::unique_lock lock(mutex);
+    for (std::size_t & value : data.values) {
+        ++value;
+    }
+}
+
+void exclusive(auto & mutex, shared_data & data, std::size_t) {
+    write(mutex, data);
+}
+
+void read_mostly(auto & mutex, shared_data & data, std::size_t const index) {
+    if (index % read_share == 0) {
+        write(mutex, data);
+        return;
+    }
+
+    std::shared_lock lock(mutex);
+    std::size_t sum = 0;
+    for (std::size_t const value : data.values) {
+        sum += value;
+    }
+    static_cast<void>(sum);
+}
+
+struct account {
+    std::mutex mutex;
+    long balance = 0;
+};
+
+template <typename... Order>
+[[nodiscard]] double transfers_per_second(std::size_t const threads_count, Order... order) {
+    std::vector<account> accounts(accounts_count);
+    std::size_t const transfers_per_thread = operations_count / threads_count;
+    std::latch start(static_cast<std::ptrdiff_t>(threads_count) + 1);
+
+    std::vector<std::jthread> threads;
+    threads.reserve(threads_count);
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        threads.emplace_back([&, i] {
+            start.arrive_and_wait();
+            for (std::size_t j = 0; j < transfers_per_thread; ++j) {
+                account & from = accounts[(i + j) % accounts_count];
+                account & to = accounts[(i + j + 1 + i % 2) % accounts_count];
+                if (&from == &to) {
+                    continue;
+                }
+
+                eon::mt::unique_lock lock(order..., from.mutex, to.mutex);
+                --from.balance;
+                ++to.balance;
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    eon::chrono::timer const timer;
+    threads.clear();
+
+    return static_cast<double>(transfers_per_thread * threads_count) / timer.elapsed();
+}
+
+int main() {
+    std::cout << "exclusive\n"
+              << "threads | std::mutex, ops/s | adaptive_mutex, ops/s\n";
+
+    for (std::size_t const threads_count : {1, 4, 16}) {
+        std::cout << threads_count << " | "
+                  << operations_per_second<std::mutex>(threads_count, [](auto &... args) { exclusive(args...); }) << " | "
+                  << operations_per_second<eon::mt::adaptive_mutex>(threads_count, [](auto &... args) { exclusive(args...); }) << '\n';
+    }
+
+    std::cout << "\nread-mostly\n"
+              << "threads | std::shared_mutex, ops/s | shared_mutex, ops/s | sharded_shared_mutex, ops/s\n";
+
+    for (std::size_t const threads_count : {1, 4, 16}) {
+        auto const operation = [](auto & mutex, shared_data & data, std::size_t const index) { read_mostly(mutex, data, index); };
+        std::cout << threads_count << " | "
+                  << operations_per_second<std::shared_mutex>(threads_count, operation) << " | "
+                  << operations_per_second<eon::mt::shared_mutex>(threads_count, operation) << " | "
+                  << operations_per_second<eon::mt::sharded_shared_mutex>(threads_count, operation) << '\n';
+    }
+
+    std::cout << "\ntransfers\n"
+              << "threads | std::lock, transfers/s | address_order, transfers/s\n";
+
+    for (std::size_t const threads_count : {2, 8, 32}) {
+        std::cout << threads_count << " | "
+                  << transfers_per_second(threads_count) << " | "
+                  << transfers_per_second(threads_count, eon::mt::address_order) << '\n';
+    }
+
+    return 0;
+}
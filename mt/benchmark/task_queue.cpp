@@ -0,0 +1,53 @@
+#include <iostream>
+#include <vector>
+#include <latch>
+
+#include <eon/mt.hpp>
+#include <eon/chrono.hpp>
+
+// Measures add_task-to-completion throughput: every producer adds its share of empty tasks
+// and waits for their futures, the time is taken until the last task has completed
+
+constexpr std::size_t tasks_count = 1 << 18;
+
+template <eon::mt::scheduling Sched>
+[[nodiscard]] double tasks_per_second(std::size_t const producers_count) {
+    eon::mt::thread_pool<void, Sched> thread_pool;
+    std::size_t const tasks_per_producer = tasks_count / producers_count;
+    std::latch start(static_cast<std::ptrdiff_t>(producers_count) + 1);
+
+    std::vector<std::jthread> producers;
+    producers.reserve(producers_count);
+    for (std::size_t i = 0; i < producers_count; ++i) {
+        producers.emplace_back([&] {
+            std::vector<eon::mt::future<void>> futures;
+            futures.reserve(tasks_per_producer);
+            start.arrive_and_wait();
+
+            for (std::size_t j = 0; j < tasks_per_producer; ++j) {
+                futures.push_back(thread_pool.add_task([] {}));
+            }
+            for (auto & future : futures) {
+                future.get();
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    eon::chrono::timer const timer;
+    producers.clear();
+
+    return static_cast<double>(tasks_per_producer * producers_count) / timer.elapsed();
+}
+
+int main() {
+    std::cout << "producers | shared_queue, tasks/s | lock_free, tasks/s\n";
+
+    for (std::size_t const producers_count : {1, 8, 64}) {
+        std::cout << producers_count << " | "
+                  << tasks_per_second<eon::mt::scheduling::shared_queue>(producers_count) << " | "
+                  << tasks_per_second<eon::mt::scheduling::lock_free>(producers_count) << '\n';
+    }
+
+    return 0;
+}
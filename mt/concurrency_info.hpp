@@ -1,9 +1,30 @@
 #pragma once
 
 #include <thread>
+#include <algorithm>
+#include <cstddef>
+
+#include <eon/mt/topology.hpp>
 
 namespace eon::mt {
 
+    /**
+     * @brief Assumed size of a cache line, used to keep independently modified data on separate lines
+     */
+    inline constexpr std::size_t cache_line_size = 64;
+
+    namespace detail {
+
+        /**
+         * @brief Keeps a value on its own cache line, so values of different threads don't share lines
+         */
+        template <typename T>
+        struct alignas(cache_line_size) padded {
+            T value;
+        };
+
+    }
+
     /**
      * @brief Returns the number of hardware thread contexts or 1 if this information is unavailable.
      */
@@ -34,4 +55,71 @@ namespace eon::mt {
         return std::min(n, concurrent_available());
     }
 
+    /**
+     * @brief Hardware units to count threads by
+     */
+    enum class concurrency_unit {
+        logical_cpu,    ///< every hardware thread context
+        physical_core,  ///< one thread per physical core, SMT siblings stay idle
+        cache_domain,   ///< physical cores sharing one last-level (L3) cache
+        numa_node       ///< physical cores of one NUMA node
+    };
+
+    /**
+     * @brief Returns the number of <b>unit</b>s of this machine or 1 if this information is unavailable.
+     * For cache_domain and numa_node it's the number of physical cores in the smallest domain or node
+     */
+    [[nodiscard]] inline unsigned int available(concurrency_unit const unit) {
+        topology const & topology = topology::system();
+
+        auto const smallest_group = [&topology](std::span<topology::cpu_group const> groups) {
+            std::size_t cores = topology.cores().size();
+            for (auto const & group : groups) {
+                cores = std::min(cores, topology.cores_count(group));
+            }
+            return cores;
+        };
+
+        std::size_t count = 0;
+        switch (unit) {
+            case concurrency_unit::logical_cpu:
+                count = topology.cpus().size();
+                break;
+            case concurrency_unit::physical_core:
+                count = topology.cores().size();
+                break;
+            case concurrency_unit::cache_domain:
+                count = smallest_group(topology.cache_domains(3));
+                break;
+            case concurrency_unit::numa_node:
+                count = smallest_group(topology.nodes());
+                break;
+        }
+
+        return std::max(1u, static_cast<unsigned int>(count));
+    }
+
+    /**
+     * @brief Returns the number of <b>unit</b>s of this machine or 2 if this information is unavailable.
+     */
+    [[nodiscard]] inline unsigned int concurrent_available(concurrency_unit const unit) {
+        return std::max(2u, available(unit));
+    }
+
+    /**
+     * @brief Returns the optimal number of threads counted by <b>unit</b> for a task size of <b>n</b>.
+     * Actually returns std::min(n, eon::mt::available(unit)).
+     */
+    [[nodiscard]] inline unsigned int optimal(unsigned int const n, concurrency_unit const unit) {
+        return std::min(n, available(unit));
+    }
+
+    /**
+     * @brief Returns the optimal number of threads counted by <b>unit</b> for a task size of <b>n</b>.
+     * Actually returns std::min(n, eon::mt::concurrent_available(unit)).
+     */
+    [[nodiscard]] inline unsigned int concurrent_optimal(unsigned int const n, concurrency_unit const unit) {
+        return std::min(n, concurrent_available(unit));
+    }
+
 }
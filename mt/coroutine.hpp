@@ -0,0 +1,598 @@
+#pragma once
+
+#include <coroutine>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <tuple>
+#include <span>
+#include <memory>
+#include <optional>
+#include <variant>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <future>
+#include <type_traits>
+#include <concepts>
+#include <cstddef>
+
+#include <eon/mt/future.hpp>
+
+namespace eon::mt {
+
+    template <typename T = void>
+    class task;
+
+    namespace detail {
+
+        class task_promise_base {
+            struct final_awaiter {
+                [[nodiscard]] bool await_ready() const noexcept {
+                    return false;
+                }
+
+                template <typename Promise>
+                [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+                    std::coroutine_handle<> const continuation = handle.promise().continuation();
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+        public:
+            [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+                return {};
+            }
+
+            [[nodiscard]] final_awaiter final_suspend() const noexcept {
+                return {};
+            }
+
+            void unhandled_exception() noexcept {
+                m_exception = std::current_exception();
+            }
+
+            void set_continuation(std::coroutine_handle<> const continuation) noexcept {
+                m_continuation = continuation;
+            }
+
+            [[nodiscard]] std::coroutine_handle<> continuation() const noexcept {
+                return m_continuation;
+            }
+
+        protected:
+            void rethrow_if_failed() const {
+                if (m_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+        private:
+            std::coroutine_handle<> m_continuation;
+            std::exception_ptr m_exception;
+        };
+
+        template <typename T>
+        class task_promise : public task_promise_base {
+        public:
+            [[nodiscard]] task<T> get_return_object() noexcept;
+
+            template <typename U = T>
+            requires (std::convertible_to<U &&, T>)
+            void return_value(U && value) {
+                if constexpr (std::is_reference_v<T>) {
+                    m_value.emplace(std::addressof(value));
+                }
+                else {
+                    m_value.emplace(std::forward<U>(value));
+                }
+            }
+
+            T result() {
+                rethrow_if_failed();
+                if constexpr (std::is_reference_v<T>) {
+                    return static_cast<T>(**m_value);
+                }
+                else {
+                    return std::move(*m_value);
+                }
+            }
+
+        private:
+            std::optional<stored_result_t<T>> m_value;
+        };
+
+        template <>
+        class task_promise<void> : public task_promise_base {
+        public:
+            [[nodiscard]] task<void> get_return_object() noexcept;
+
+            void return_void() const noexcept {}
+
+            void result() const {
+                rethrow_if_failed();
+            }
+        };
+
+    }
+
+    /**
+     * @brief Lazy coroutine producing a value of type <b>T</b>. It starts when it is awaited,
+     * and the awaiting coroutine is resumed on the thread which completes it
+     */
+    template <typename T>
+    class [[nodiscard]] task {
+    public:
+        using promise_type = detail::task_promise<T>;
+        using value_type = T;
+
+    private:
+        using handle_t = std::coroutine_handle<promise_type>;
+
+        struct awaiter {
+            handle_t handle;
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return !handle || handle.done();
+            }
+
+            [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<> const continuation) const noexcept {
+                handle.promise().set_continuation(continuation);
+                return handle;
+            }
+
+            T await_resume() const {
+                if (!handle) {
+                    throw std::future_error(std::future_errc::no_state);
+                }
+                return handle.promise().result();
+            }
+        };
+
+    public:
+        task() noexcept = default;
+
+        explicit task(handle_t const handle) noexcept : m_handle(handle) {}
+
+        task(task && other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+        task & operator=(task && other) noexcept {
+            if (this != &other) {
+                destroy();
+                m_handle = std::exchange(other.m_handle, {});
+            }
+            return *this;
+        }
+
+        ~task() {
+            destroy();
+        }
+
+        /**
+         * @brief checks whether the task refers to a coroutine
+         */
+        [[nodiscard]] bool valid() const noexcept {
+            return static_cast<bool>(m_handle);
+        }
+
+        /**
+         * @brief checks whether the coroutine has completed
+         */
+        [[nodiscard]] bool is_ready() const noexcept {
+            return m_handle && m_handle.done();
+        }
+
+        awaiter operator co_await() const & noexcept {
+            return awaiter{m_handle};
+        }
+
+        awaiter operator co_await() const && noexcept {
+            return awaiter{m_handle};
+        }
+
+    private:
+        void destroy() noexcept {
+            if (m_handle) {
+                m_handle.destroy();
+            }
+        }
+
+    private:
+        handle_t m_handle;
+    };
+
+    namespace detail {
+
+        template <typename T>
+        task<T> task_promise<T>::get_return_object() noexcept {
+            return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+        }
+
+        inline task<void> task_promise<void>::get_return_object() noexcept {
+            return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+        }
+
+        /**
+         * @brief Eager coroutine which destroys itself on completion
+         */
+        struct detached_task {
+            struct promise_type {
+                [[nodiscard]] detached_task get_return_object() const noexcept {
+                    return {};
+                }
+
+                [[nodiscard]] std::suspend_never initial_suspend() const noexcept {
+                    return {};
+                }
+
+                [[nodiscard]] std::suspend_never final_suspend() const noexcept {
+                    return {};
+                }
+
+                void return_void() const noexcept {}
+
+                void unhandled_exception() const noexcept {
+                    std::terminate();
+                }
+            };
+        };
+
+        /**
+         * @brief stores the result of an awaited task to <b>value</b>, references are stored as pointers
+         */
+        template <typename T, typename U>
+        void store_result(std::optional<stored_result_t<T>> & value, U && result) {
+            if constexpr (std::is_reference_v<T>) {
+                value.emplace(std::addressof(result));
+            }
+            else {
+                value.emplace(std::forward<U>(result));
+            }
+        }
+
+        /**
+         * @brief moves the result out of <b>value</b>, std::monostate for void
+         */
+        template <typename T>
+        [[nodiscard]] std::conditional_t<std::is_void_v<T>, std::monostate, T> take_result(std::optional<stored_result_t<T>> & value) {
+            if constexpr (std::is_reference_v<T>) {
+                return static_cast<T>(**value);
+            }
+            else {
+                return std::move(*value);
+            }
+        }
+
+        template <typename T>
+        detached_task run_detached(task<T> task, promise<T> result) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await task;
+                    result.set_value();
+                }
+                else {
+                    result.set_value(co_await task);
+                }
+            }
+            catch (...) {
+                result.set_exception(std::current_exception());
+            }
+        }
+
+        /**
+         * @brief Counts the unfinished sub-tasks of when_all plus one for the awaiting coroutine,
+         * whoever brings it to zero resumes the awaiting coroutine
+         */
+        struct when_all_counter {
+            explicit when_all_counter(std::size_t const tasks_count) noexcept : count(tasks_count + 1) {}
+
+            std::atomic<std::size_t> count;
+            std::coroutine_handle<> continuation;
+        };
+
+        /**
+         * @brief Lazy coroutine which awaits one sub-task of when_all and decrements the counter when it is done
+         */
+        class when_all_notifier {
+        public:
+            struct promise_type {
+                struct final_awaiter {
+                    [[nodiscard]] bool await_ready() const noexcept {
+                        return false;
+                    }
+
+                    [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> const handle) const noexcept {
+                        when_all_counter & counter = *handle.promise().counter;
+                        return counter.count.fetch_sub(1, std::memory_order_acq_rel) == 1 ? counter.continuation : std::noop_coroutine();
+                    }
+
+                    void await_resume() const noexcept {}
+                };
+
+                [[nodiscard]] when_all_notifier get_return_object() noexcept {
+                    return when_all_notifier(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+
+                [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+                    return {};
+                }
+
+                [[nodiscard]] final_awaiter final_suspend() const noexcept {
+                    return {};
+                }
+
+                void return_void() const noexcept {}
+
+                void unhandled_exception() const noexcept {
+                    std::terminate();
+                }
+
+                when_all_counter * counter = nullptr;
+            };
+
+            explicit when_all_notifier(std::coroutine_handle<promise_type> const handle) noexcept : m_handle(handle) {}
+
+            when_all_notifier(when_all_notifier && other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+            when_all_notifier & operator=(when_all_notifier &&) = delete;
+
+            ~when_all_notifier() {
+                if (m_handle) {
+                    m_handle.destroy();
+                }
+            }
+
+            void start(when_all_counter & counter) const noexcept {
+                m_handle.promise().counter = &counter;
+                m_handle.resume();
+            }
+
+        private:
+            std::coroutine_handle<promise_type> m_handle;
+        };
+
+        template <typename T>
+        when_all_notifier make_when_all_notifier(task<T> & task, std::optional<stored_result_t<T>> & value, std::exception_ptr & exception) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await task;
+                    value.emplace();
+                }
+                else {
+                    store_result<T>(value, co_await task);
+                }
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        /**
+         * @brief starts all the <b>notifiers</b> and suspends the awaiting coroutine until they are done
+         */
+        class when_all_awaiter {
+        public:
+            when_all_awaiter(std::span<when_all_notifier> const notifiers, when_all_counter & counter) noexcept : m_notifiers(notifiers), m_counter(counter) {}
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            [[nodiscard]] bool await_suspend(std::coroutine_handle<> const continuation) const noexcept {
+                m_counter.continuation = continuation;
+                for (when_all_notifier const & notifier : m_notifiers) {
+                    notifier.start(m_counter);
+                }
+                return m_counter.count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            std::span<when_all_notifier> m_notifiers;
+            when_all_counter & m_counter;
+        };
+
+        template <typename T>
+        struct when_any_state {
+            std::vector<task<T>> tasks;
+            std::atomic<bool> has_winner = false;
+            std::atomic<bool> has_met = false; // the winner and the awaiting coroutine, the later of them resumes the latter
+            std::size_t index = 0;
+            std::optional<stored_result_t<T>> value;
+            std::exception_ptr exception;
+            std::coroutine_handle<> continuation;
+        };
+
+        template <typename T>
+        detached_task run_when_any(std::shared_ptr<when_any_state<T>> state, std::size_t const index) {
+            std::optional<stored_result_t<T>> value;
+            std::exception_ptr exception;
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await state->tasks[index];
+                    value.emplace();
+                }
+                else {
+                    store_result<T>(value, co_await state->tasks[index]);
+                }
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            if (state->has_winner.exchange(true, std::memory_order_acq_rel)) {
+                co_return;
+            }
+
+            state->index = index;
+            state->value = std::move(value);
+            state->exception = std::move(exception);
+            if (state->has_met.exchange(true, std::memory_order_acq_rel)) {
+                state->continuation.resume();
+            }
+        }
+
+        template <typename T>
+        class when_any_awaiter {
+        public:
+            explicit when_any_awaiter(std::shared_ptr<when_any_state<T>> state) noexcept : m_state(std::move(state)) {}
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            [[nodiscard]] bool await_suspend(std::coroutine_handle<> const continuation) const {
+                // the awaiter may be destroyed as soon as the awaiting coroutine is resumed, so the state is kept alive by a copy
+                std::shared_ptr<when_any_state<T>> const state = m_state;
+                state->continuation = continuation;
+                for (std::size_t i = 0; i < state->tasks.size(); ++i) {
+                    run_when_any(state, i);
+                }
+                return !state->has_met.exchange(true, std::memory_order_acq_rel);
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            std::shared_ptr<when_any_state<T>> m_state;
+        };
+
+    }
+
+    template <typename T>
+    using when_all_value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    /**
+     * @brief Returns an awaitable which resumes the awaiting coroutine on a worker of <b>pool</b>
+     */
+    template <scheduler Pool>
+    [[nodiscard]] auto schedule_on(Pool & pool) noexcept {
+        struct awaiter {
+            Pool & pool;
+
+            [[nodiscard]] bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> const handle) const {
+                pool.post([handle] { handle.resume(); });
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        return awaiter{pool};
+    }
+
+    /**
+     * @brief Starts <b>task</b> on the calling thread and returns the future for its result.
+     * The task runs on the calling thread until its first suspension
+     */
+    template <typename T>
+    [[nodiscard]] future<T> start(task<T> task) {
+        promise<T> promise;
+        future<T> future = promise.get_future();
+        detail::run_detached(std::move(task), std::move(promise));
+        return future;
+    }
+
+    /**
+     * @brief Starts <b>task</b> and blocks the calling thread until it completes
+     */
+    template <typename T>
+    T sync_wait(task<T> task) {
+        return mt::start(std::move(task)).get();
+    }
+
+    /**
+     * @brief Returns the task which runs all the <b>tasks</b> concurrently and completes when all of them are done.
+     * Its result holds the results in the order of the tasks, the first exception (in the same order) is rethrown
+     */
+    template <typename T>
+    requires (!std::is_reference_v<T>)
+    [[nodiscard]] task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(std::vector<task<T>> tasks) {
+        std::vector<std::optional<detail::stored_result_t<T>>> values(tasks.size());
+        std::vector<std::exception_ptr> exceptions(tasks.size());
+
+        std::vector<detail::when_all_notifier> notifiers;
+        notifiers.reserve(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            notifiers.push_back(detail::make_when_all_notifier(tasks[i], values[i], exceptions[i]));
+        }
+
+        detail::when_all_counter counter(tasks.size());
+        co_await detail::when_all_awaiter(notifiers, counter);
+
+        for (std::exception_ptr const & exception : exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        if constexpr (!std::is_void_v<T>) {
+            std::vector<T> results;
+            results.reserve(values.size());
+            for (auto & value : values) {
+                results.push_back(detail::take_result<T>(value));
+            }
+            co_return results;
+        }
+    }
+
+    /**
+     * @brief Returns the task which runs all the <b>tasks</b> concurrently and completes when all of them are done.
+     * Its result is the tuple of their results, std::monostate for void tasks
+     */
+    template <typename... Ts>
+    [[nodiscard]] task<std::tuple<when_all_value_t<Ts>...>> when_all(task<Ts>... tasks) {
+        std::tuple<std::optional<detail::stored_result_t<Ts>>...> values;
+        std::array<std::exception_ptr, sizeof...(Ts)> exceptions;
+
+        auto notifiers = [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::array<detail::when_all_notifier, sizeof...(Ts)>{detail::make_when_all_notifier(tasks, std::get<I>(values), exceptions[I])...};
+        }(std::index_sequence_for<Ts...>{});
+
+        detail::when_all_counter counter(sizeof...(Ts));
+        co_await detail::when_all_awaiter(notifiers, counter);
+
+        for (std::exception_ptr const & exception : exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        co_return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return std::tuple<when_all_value_t<Ts>...>(detail::take_result<Ts>(std::get<I>(values))...);
+        }(std::index_sequence_for<Ts...>{});
+    }
+
+    /**
+     * @brief Returns the task which runs all the <b>tasks</b> concurrently and completes when the first of them is done.
+     * Its result holds the index and the result of that task, the other tasks keep running and their results are discarded
+     */
+    template <typename T>
+    [[nodiscard]] task<when_any_result<T>> when_any(std::vector<task<T>> tasks) {
+        if (tasks.empty()) {
+            throw std::invalid_argument("when_any requires at least one task");
+        }
+
+        auto const state = std::make_shared<detail::when_any_state<T>>();
+        state->tasks = std::move(tasks);
+        co_await detail::when_any_awaiter<T>(state);
+
+        if (state->exception) {
+            std::rethrow_exception(state->exception);
+        }
+
+        if constexpr (std::is_void_v<T>) {
+            co_return when_any_result<void>{state->index};
+        }
+        else {
+            co_return when_any_result<T>{state->index, detail::take_result<T>(state->value)};
+        }
+    }
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace eon::mt::detail {
+
+    /**
+     * @brief Lets threads sleep on std::atomic::wait until some condition checked outside of it becomes true.
+     * A waiter calls prepare_wait(), rechecks the condition and then either cancel_wait() or wait(key).
+     * A notifier makes the condition true and then calls notify_one() or notify_all().
+     * The notification can't be lost between the recheck and wait(key) because wait(key) returns immediately
+     * if there was a notification since prepare_wait()
+     */
+    class event_count {
+    public:
+        using key_type = std::uint32_t;
+
+        [[nodiscard]] key_type prepare_wait() noexcept {
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return m_epoch.load(std::memory_order_acquire);
+        }
+
+        void cancel_wait() noexcept {
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void wait(key_type const key) noexcept {
+            m_epoch.wait(key, std::memory_order_acquire);
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void notify_one() noexcept {
+            if (has_waiters()) {
+                m_epoch.fetch_add(1, std::memory_order_acq_rel);
+                m_epoch.notify_one();
+            }
+        }
+
+        void notify_all() noexcept {
+            if (has_waiters()) {
+                m_epoch.fetch_add(1, std::memory_order_acq_rel);
+                m_epoch.notify_all();
+            }
+        }
+
+        /**
+         * @brief wakes up to <b>count</b> waiters, all of them with one call if there are not more than <b>count</b>
+         */
+        void notify(std::size_t const count) noexcept {
+            if (!has_waiters()) {
+                return;
+            }
+
+            m_epoch.fetch_add(1, std::memory_order_acq_rel);
+            if (count >= m_waiters.load(std::memory_order_relaxed)) {
+                m_epoch.notify_all();
+                return;
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                m_epoch.notify_one();
+            }
+        }
+
+        /**
+         * @brief returns the number of threads between prepare_wait() and the end of wait(key) or cancel_wait()
+         */
+        [[nodiscard]] std::uint32_t waiters() const noexcept {
+            return m_waiters.load(std::memory_order_relaxed);
+        }
+
+    private:
+        [[nodiscard]] bool has_waiters() const noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return m_waiters.load(std::memory_order_relaxed) > 0;
+        }
+
+    private:
+        std::atomic<key_type> m_epoch = 0;
+        std::atomic<std::uint32_t> m_waiters = 0;
+    };
+
+}
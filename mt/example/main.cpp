@@ -1,5 +1,10 @@
 #include <iostream>
 #include <syncstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <eon/mt.hpp>
 
@@ -18,5 +23,68 @@ int main() {
 
     std::cout << future1.get() << ' ' << future2.get() << std::endl;
 
+    // one pool for tasks with different results
+    eon::mt::thread_pool<> common_pool;
+
+    auto number = common_pool.submit([] { return 42; });
+    auto text = common_pool.submit([] { return std::string("forty two"); });
+
+    std::cout << number.get() << ' ' << text.get() << std::endl;
+
+    // move-only tasks are moved from the range, with or without a key
+    std::vector<eon::mt::small_task> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.emplace_back([i] { std::osyncstream(std::cout) << "task " << i << std::endl; });
+    }
+    common_pool.post_bulk(tasks);
+
+    std::vector<eon::mt::small_task> keyed_tasks;
+    for (int i = 0; i < 4; ++i) {
+        keyed_tasks.emplace_back([i] { std::osyncstream(std::cout) << "keyed task " << i << std::endl; });
+    }
+    common_pool.post_bulk(eon::mt::affinity_key{42}, keyed_tasks);
+
+    // the workers of a work-stealing pool push to their own deques, which are handed over when the pool shrinks
+    using namespace std::chrono_literals;
+    eon::mt::thread_pool<void, eon::mt::scheduling::work_stealing> stealing_pool(4);
+    std::atomic<int> done = 0;
+    auto const spawn = [&stealing_pool, &done] {
+        stealing_pool.post([&done] { ++done; });
+        ++done;
+    };
+
+    int posted = 0;
+    for (int round = 0; round < 50; ++round) {
+        for (unsigned const size : {1u, 6u, 2u, 8u, 4u}) {
+            for (int i = 0; i < 20; ++i, posted += 2) {
+                stealing_pool.post(spawn);
+            }
+            if (round % 2 == 0) {
+                stealing_pool.resize(size);
+            }
+            else {
+                stealing_pool.force_resize(size);
+            }
+        }
+    }
+
+    // an elastic pool retires its idle workers between the bursts
+    eon::mt::thread_pool<void, eon::mt::scheduling::work_stealing> elastic_pool(
+        eon::mt::elastic_options{.min_threads = 1, .max_threads = 8, .grow_queue_depth = 1, .grow_wait = 100us, .keep_alive = 2ms});
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 100; ++i, posted += 2) {
+            elastic_pool.post([&elastic_pool, &done] {
+                elastic_pool.post([&done] { ++done; });
+                ++done;
+            });
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+
+    while (done.load() < posted) {
+        std::this_thread::sleep_for(1ms);
+    }
+    std::cout << done.load() << " stress tasks done" << std::endl;
+
     return 0;
 }
@@ -0,0 +1,534 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <future>
+#include <stdexcept>
+#include <optional>
+#include <variant>
+#include <exception>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+#include <eon/mt/slab_allocator.hpp>
+#include <eon/mt/small_task.hpp>
+
+namespace eon::mt {
+
+    template <typename T>
+    class future;
+
+    template <typename T>
+    class promise;
+
+    /**
+     * @brief Thread pool or any other executor which can run a callable
+     */
+    template <typename Pool>
+    concept scheduler = requires(Pool & pool) {
+        pool.post([] {});
+    };
+
+    /**
+     * @brief Result of when_any: <b>index</b> of the first finished task or future and <b>value</b>,
+     * which is the result of that task for coroutines and all the futures (the one at <b>index</b> is ready) for futures
+     */
+    template <typename T>
+    struct when_any_result {
+        std::size_t index;
+        T value;
+    };
+
+    template <>
+    struct when_any_result<void> {
+        std::size_t index;
+    };
+
+    namespace detail {
+
+        struct future_combinators;
+
+        /**
+         * @brief Callable to run once a shared state is ready, continuations of one state form a lock-free stack
+         */
+        struct continuation_node {
+            small_task task;
+            continuation_node * next = nullptr;
+        };
+
+        /**
+         * @brief returns the marker which replaces the continuations of a ready state
+         */
+        [[nodiscard]] inline continuation_node * ready_mark() noexcept {
+            static continuation_node mark;
+            return &mark;
+        }
+
+        template <typename T>
+        using stored_result_t = std::conditional_t<std::is_void_v<T>, std::monostate,
+                                std::conditional_t<std::is_reference_v<T>, std::remove_reference_t<T> *, T>>;
+
+        /**
+         * @brief State shared by a promise and its future. Waiting is done on std::atomic::wait.
+         * The state is allocated from a slab_allocator if it's given and released when both sides are gone
+         */
+        template <typename T>
+        class shared_state {
+            explicit shared_state(slab_allocator * allocator) noexcept : m_allocator(allocator) {}
+
+        public:
+            shared_state(shared_state const &) = delete;
+            shared_state & operator=(shared_state const &) = delete;
+
+            ~shared_state() {
+                continuation_node * node = m_continuations.load(std::memory_order_acquire);
+                while (node != nullptr && node != ready_mark()) {
+                    delete std::exchange(node, node->next);
+                }
+            }
+
+            [[nodiscard]] static shared_state * make(slab_allocator * allocator) {
+                if (allocator == nullptr || alignof(shared_state) > alignof(std::max_align_t)) {
+                    return new shared_state(nullptr);
+                }
+                return ::new (allocator->allocate(sizeof(shared_state))) shared_state(allocator);
+            }
+
+            template <typename... Args>
+            void set_value(Args &&... args) {
+                validate_not_ready();
+                if constexpr (std::is_reference_v<T>) {
+                    m_value.emplace(std::addressof(args)...);
+                }
+                else {
+                    m_value.emplace(std::forward<Args>(args)...);
+                }
+                make_ready();
+            }
+
+            void set_exception(std::exception_ptr exception) {
+                validate_not_ready();
+                m_exception = std::move(exception);
+                make_ready();
+            }
+
+            [[nodiscard]] bool is_ready() const noexcept {
+                return m_ready.load(std::memory_order_acquire) != 0;
+            }
+
+            void wait() const noexcept {
+                while (!is_ready()) {
+                    m_ready.wait(0, std::memory_order_acquire);
+                }
+            }
+
+            /**
+             * @brief runs <b>task</b> once the state is ready: on the thread which makes it ready
+             * or right away on the calling thread if it's already ready
+             */
+            void add_continuation(small_task task) {
+                auto * const node = new continuation_node{std::move(task)};
+                continuation_node * head = m_continuations.load(std::memory_order_acquire);
+                do {
+                    if (head == ready_mark()) {
+                        std::unique_ptr<continuation_node> const ready_node(node);
+                        ready_node->task();
+                        return;
+                    }
+                    node->next = head;
+                } while (!m_continuations.compare_exchange_weak(head, node, std::memory_order_acq_rel, std::memory_order_acquire));
+            }
+
+            /**
+             * @brief returns the stored value or rethrows the stored exception. Must be called only once the state is ready
+             */
+            T take_result() {
+                if (m_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+
+                if constexpr (std::is_reference_v<T>) {
+                    return static_cast<T>(**m_value);
+                }
+                else if constexpr (!std::is_void_v<T>) {
+                    return std::move(*m_value);
+                }
+            }
+
+            void release() noexcept {
+                if (m_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                    return;
+                }
+
+                slab_allocator * const allocator = m_allocator;
+                if (allocator == nullptr) {
+                    delete this;
+                }
+                else {
+                    this->~shared_state();
+                    allocator->deallocate(this, sizeof(shared_state));
+                }
+            }
+
+        private:
+            void validate_not_ready() const {
+                if (is_ready()) {
+                    throw std::future_error(std::future_errc::promise_already_satisfied);
+                }
+            }
+
+            void make_ready() noexcept {
+                m_ready.store(1, std::memory_order_release);
+                m_ready.notify_all();
+
+                // the stack holds the latest continuation first, they are run in the order they were added
+                continuation_node * reversed = nullptr;
+                continuation_node * node = m_continuations.exchange(ready_mark(), std::memory_order_acq_rel);
+                while (node != nullptr) {
+                    node = std::exchange(node->next, std::exchange(reversed, node));
+                }
+
+                while (reversed != nullptr) {
+                    std::unique_ptr<continuation_node> const current(std::exchange(reversed, reversed->next));
+                    current->task();
+                }
+            }
+
+        private:
+            std::atomic<std::uint32_t> m_ready = 0;
+            std::atomic<std::uint32_t> m_refs = 2;
+            std::atomic<continuation_node *> m_continuations = nullptr;
+            slab_allocator * const m_allocator;
+            std::exception_ptr m_exception;
+            std::optional<stored_result_t<T>> m_value;
+        };
+
+        struct state_releaser {
+            template <typename State>
+            void operator()(State * state) const noexcept {
+                state->release();
+            }
+        };
+
+        template <typename T>
+        using state_ptr = std::unique_ptr<shared_state<T>, state_releaser>;
+
+        /**
+         * @brief invokes <b>fn</b> and stores its result or thrown exception to <b>promise</b>
+         */
+        template <typename T, typename Fn>
+        void invoke_into(promise<T> & promise, Fn & fn) noexcept {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    std::invoke(fn);
+                    promise.set_value();
+                }
+                else {
+                    promise.set_value(std::invoke(fn));
+                }
+            }
+            catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+    }
+
+    /**
+     * @brief Lightweight analogue of <b>std::future</b>, waits on std::atomic::wait
+     */
+    template <typename T>
+    class future {
+        friend class promise<T>;
+        friend struct detail::future_combinators;
+
+        explicit future(detail::shared_state<T> * state) noexcept : m_state(state) {}
+
+    public:
+        future() noexcept = default;
+
+        future(future &&) noexcept = default;
+        future & operator=(future &&) noexcept = default;
+
+        /**
+         * @brief checks whether the future refers to a shared state
+         */
+        [[nodiscard]] bool valid() const noexcept {
+            return m_state != nullptr;
+        }
+
+        /**
+         * @brief checks whether the result is available, so get() won't block
+         */
+        [[nodiscard]] bool is_ready() const {
+            validate();
+            return m_state->is_ready();
+        }
+
+        /**
+         * @brief blocks until the result is available
+         */
+        void wait() const {
+            validate();
+            m_state->wait();
+        }
+
+        /**
+         * @brief waits for the result and returns it (or rethrows the stored exception). Invalidates the future
+         */
+        T get() {
+            validate();
+            detail::state_ptr<T> const state = std::move(m_state);
+            state->wait();
+            return state->take_result();
+        }
+
+        /**
+         * @brief attaches <b>fn</b> which is called with this future once it is ready and returns the future for its result.
+         * <b>fn</b> runs on the thread which makes this future ready or on the calling thread if it's already ready.
+         * Invalidates the future
+         */
+        template <typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &, future>)
+        [[nodiscard]] future<std::invoke_result_t<std::decay_t<Fn> &, future>> then(Fn && fn) {
+            auto [state, continuation, result] = make_continuation(std::forward<Fn>(fn));
+            state->add_continuation(std::move(continuation));
+            return std::move(result);
+        }
+
+        /**
+         * @brief like then(fn), but <b>fn</b> is posted to <b>pool</b> once this future is ready
+         */
+        template <scheduler Pool, typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &, future>)
+        [[nodiscard]] future<std::invoke_result_t<std::decay_t<Fn> &, future>> then(Pool & pool, Fn && fn) {
+            auto [state, continuation, result] = make_continuation(std::forward<Fn>(fn));
+            state->add_continuation([&pool, continuation = std::move(continuation)]() mutable {
+                pool.post(std::move(continuation));
+            });
+            return std::move(result);
+        }
+
+    private:
+        /**
+         * @brief moves this future into the callable invoking <b>fn</b> with it,
+         * returns the state to attach the callable to, the callable and the future for its result
+         */
+        template <typename Fn>
+        [[nodiscard]] auto make_continuation(Fn && fn) {
+            using result_t = std::invoke_result_t<std::decay_t<Fn> &, future>;
+
+            validate();
+            detail::shared_state<T> * const state = m_state.get();
+            promise<result_t> promise;
+            future<result_t> result = promise.get_future();
+
+            auto continuation = [promise = std::move(promise), fn = std::forward<Fn>(fn), self = std::move(*this)]() mutable {
+                auto call = [&fn, &self] { return std::invoke(fn, std::move(self)); };
+                detail::invoke_into(promise, call);
+            };
+            return std::tuple(state, std::move(continuation), std::move(result));
+        }
+
+        void validate() const {
+            if (m_state == nullptr) {
+                throw std::future_error(std::future_errc::no_state);
+            }
+        }
+
+    private:
+        detail::state_ptr<T> m_state;
+        std::shared_ptr<void const> m_owner;    // released before the state, e.g. to join the threads producing the result
+    };
+
+    /**
+     * @brief Lightweight analogue of <b>std::promise</b> which can allocate its shared state from a slab allocator
+     */
+    template <typename T>
+    class promise {
+    public:
+        promise() : m_state(detail::shared_state<T>::make(nullptr)) {}
+
+        explicit promise(detail::slab_allocator & allocator) : m_state(detail::shared_state<T>::make(&allocator)) {}
+
+        promise(promise &&) noexcept = default;
+
+        promise & operator=(promise && other) noexcept {
+            promise{std::move(other)}.swap(*this);
+            return *this;
+        }
+
+        ~promise() {
+            if (m_state == nullptr) {
+                return;
+            }
+
+            if (!m_state->is_ready()) {
+                m_state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+            if (!m_future_retrieved) {
+                // the future's reference is released here as nobody is going to take it
+                m_state->release();
+            }
+        }
+
+        /**
+         * @brief returns the future associated with the promise. Can be called only once
+         */
+        [[nodiscard]] future<T> get_future() {
+            validate();
+            if (m_future_retrieved) {
+                throw std::future_error(std::future_errc::future_already_retrieved);
+            }
+
+            m_future_retrieved = true;
+            return future<T>(m_state.get());
+        }
+
+        void set_value() requires (std::is_void_v<T>) {
+            validate();
+            m_state->set_value();
+        }
+
+        template <typename U = T>
+        requires (!std::is_void_v<T> && std::convertible_to<U &&, T>)
+        void set_value(U && value) {
+            validate();
+            if constexpr (std::is_reference_v<T>) {
+                m_state->set_value(value);
+            }
+            else {
+                m_state->set_value(std::forward<U>(value));
+            }
+        }
+
+        void set_exception(std::exception_ptr exception) {
+            validate();
+            m_state->set_exception(std::move(exception));
+        }
+
+        void swap(promise & other) noexcept {
+            std::swap(m_state, other.m_state);
+            std::swap(m_future_retrieved, other.m_future_retrieved);
+        }
+
+    private:
+        void validate() const {
+            if (m_state == nullptr) {
+                throw std::future_error(std::future_errc::no_state);
+            }
+        }
+
+    private:
+        detail::state_ptr<T> m_state;
+        bool m_future_retrieved = false;
+    };
+
+    namespace detail {
+
+        struct future_combinators {
+            /**
+             * @brief makes <b>future</b> co-own <b>owner</b>, which is released when the future is destroyed
+             */
+            template <typename T>
+            static void attach_owner(future<T> & future, std::shared_ptr<void const> owner) noexcept {
+                future.m_owner = std::move(owner);
+            }
+
+            template <typename T>
+            struct all_state {
+                std::vector<future<T>> futures;
+                std::atomic<std::size_t> remaining;
+                promise<std::vector<future<T>>> result;
+
+                void arrive() {
+                    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        result.set_value(std::move(futures));
+                    }
+                }
+            };
+
+            template <typename T>
+            struct any_state {
+                std::vector<future<T>> futures;
+                std::atomic<bool> has_winner = false;
+                std::atomic<bool> has_met = false; // the winner and the attaching thread, the later of them sets the result
+                std::size_t index = 0;
+                promise<when_any_result<std::vector<future<T>>>> result;
+
+                void meet() {
+                    if (has_met.exchange(true, std::memory_order_acq_rel)) {
+                        result.set_value(when_any_result<std::vector<future<T>>>{index, std::move(futures)});
+                    }
+                }
+            };
+
+            template <typename T>
+            [[nodiscard]] static future<std::vector<future<T>>> when_all(std::vector<future<T>> futures) {
+                for (future<T> const & future : futures) {
+                    future.validate();
+                }
+
+                auto const state = std::make_shared<all_state<T>>();
+                state->remaining.store(futures.size() + 1, std::memory_order_relaxed);
+                state->futures = std::move(futures);
+                auto result = state->result.get_future();
+
+                for (future<T> const & future : state->futures) {
+                    future.m_state->add_continuation([state] { state->arrive(); });
+                }
+                state->arrive();
+                return result;
+            }
+
+            template <typename T>
+            [[nodiscard]] static future<when_any_result<std::vector<future<T>>>> when_any(std::vector<future<T>> futures) {
+                if (futures.empty()) {
+                    throw std::invalid_argument("when_any requires at least one future");
+                }
+                for (future<T> const & future : futures) {
+                    future.validate();
+                }
+
+                auto const state = std::make_shared<any_state<T>>();
+                state->futures = std::move(futures);
+                auto result = state->result.get_future();
+
+                for (std::size_t i = 0; i < state->futures.size(); ++i) {
+                    state->futures[i].m_state->add_continuation([state, i] {
+                        if (!state->has_winner.exchange(true, std::memory_order_acq_rel)) {
+                            state->index = i;
+                            state->meet();
+                        }
+                    });
+                }
+                state->meet();
+                return result;
+            }
+        };
+
+    }
+
+    /**
+     * @brief Returns the future which becomes ready when all the <b>futures</b> are ready and holds them in the same order.
+     * Doesn't block, the futures' exceptions stay in them
+     */
+    template <typename T>
+    [[nodiscard]] future<std::vector<future<T>>> when_all(std::vector<future<T>> futures) {
+        return detail::future_combinators::when_all(std::move(futures));
+    }
+
+    /**
+     * @brief Returns the future which becomes ready when any of the <b>futures</b> is ready.
+     * It holds the index of that future and all the <b>futures</b>, so the rest can be passed to when_any again
+     */
+    template <typename T>
+    [[nodiscard]] future<when_any_result<std::vector<future<T>>>> when_any(std::vector<future<T>> futures) {
+        return detail::future_combinators::when_any(std::move(futures));
+    }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+namespace eon::mt {
+
+    inline constexpr std::size_t histogram_buckets = 32;
+
+    /**
+     * @brief Log2 histogram of durations: bucket i counts durations in [2^(i-1), 2^i) ns, bucket 0 counts zero durations
+     * and the last one everything longer
+     */
+    using duration_histogram = std::array<std::uint64_t, histogram_buckets>;
+
+    /**
+     * @brief returns the upper bound of the bucket containing the <b>quantile</b> (0..1) of <b>histogram</b>
+     */
+    [[nodiscard]] inline std::chrono::nanoseconds histogram_quantile(duration_histogram const & histogram, double const quantile) noexcept {
+        std::uint64_t total = 0;
+        for (std::uint64_t const count : histogram) {
+            total += count;
+        }
+        if (total == 0) {
+            return std::chrono::nanoseconds{0};
+        }
+
+        auto const rank = static_cast<std::uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < histogram.size(); ++i) {
+            seen += histogram[i];
+            if (seen >= rank) {
+                return std::chrono::nanoseconds{i == 0 ? 0 : (std::int64_t{1} << i) - 1};
+            }
+        }
+        return std::chrono::nanoseconds{(std::int64_t{1} << (histogram.size() - 1)) - 1};
+    }
+
+    namespace detail {
+
+        /**
+         * @brief increases a counter written by one thread only, so a relaxed load and store are enough
+         */
+        inline void increase(std::atomic<std::uint64_t> & counter, std::uint64_t const value) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Histogram written by one thread only, so it uses plain relaxed loads and stores, and read by any thread
+         */
+        class relaxed_histogram {
+        public:
+            void add(std::uint64_t const ns) noexcept {
+                std::size_t const bucket = std::min<std::size_t>(std::bit_width(ns), histogram_buckets - 1);
+                increase(m_buckets[bucket], 1);
+                increase(m_total, ns);
+                if (ns > m_max.load(std::memory_order_relaxed)) {
+                    m_max.store(ns, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * @brief adds the histogram to <b>histogram</b>, <b>total</b> and <b>max</b>
+             * @return the number of durations added
+             */
+            std::uint64_t add_to(duration_histogram & histogram, std::chrono::nanoseconds & total, std::chrono::nanoseconds & max) const noexcept {
+                std::uint64_t count = 0;
+                for (std::size_t i = 0; i < histogram_buckets; ++i) {
+                    std::uint64_t const bucket = m_buckets[i].load(std::memory_order_relaxed);
+                    histogram[i] += bucket;
+                    count += bucket;
+                }
+                total += std::chrono::nanoseconds{m_total.load(std::memory_order_relaxed)};
+                max = std::max(max, std::chrono::nanoseconds{m_max.load(std::memory_order_relaxed)});
+                return count;
+            }
+
+        private:
+            std::array<std::atomic<std::uint64_t>, histogram_buckets> m_buckets{};
+            std::atomic<std::uint64_t> m_total = 0;
+            std::atomic<std::uint64_t> m_max = 0;
+        };
+
+    }
+
+}
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstddef>
+
+#include <eon/mt/histogram.hpp>
+
+namespace eon::mt {
+
+    inline constexpr std::size_t lock_histogram_buckets = histogram_buckets;
+
+    /**
+     * @brief Contention statistics of one set of mutexes locked together by eon::mt::unique_lock or eon::mt::shared_lock.
+     * The histograms are eon::mt::duration_histogram
+     */
+    struct lock_profile {
+        using histogram = duration_histogram;
+
+        std::vector<void const *> mutexes;  ///< addresses of the first mutexes of the set (up to 4)
+        std::uint64_t acquisitions = 0;     ///< successful lock() and try_lock() calls
+        std::uint64_t contended = 0;        ///< lock() calls which had to wait
+        std::uint64_t try_attempts = 0;
+        std::uint64_t try_failures = 0;
+        std::chrono::nanoseconds wait_total{0};
+        std::chrono::nanoseconds wait_max{0};
+        std::chrono::nanoseconds hold_total{0};
+        std::chrono::nanoseconds hold_max{0};
+        std::uint64_t holds = 0;            ///< number of measured hold times
+        histogram wait_histogram{};
+        histogram hold_histogram{};
+
+        /**
+         * @brief returns the upper bound of the bucket containing the <b>quantile</b> (0..1) of <b>histogram</b>
+         */
+        [[nodiscard]] static std::chrono::nanoseconds quantile(histogram const & histogram, double const quantile) noexcept {
+            return histogram_quantile(histogram, quantile);
+        }
+    };
+
+    namespace detail {
+
+        inline constexpr std::size_t lock_key_size = 4;
+        inline constexpr std::size_t thread_lock_slots = 64;
+
+        /**
+         * @brief identifies a set of mutexes by their first <b>lock_key_size</b> addresses
+         */
+        struct lock_key {
+            std::array<void const *, lock_key_size> mutexes{};
+            std::size_t count = 0;
+
+            template <typename... Mutexes>
+            [[nodiscard]] static lock_key make(std::tuple<Mutexes *...> const & mutexes) noexcept {
+                lock_key key;
+                std::apply([&key](Mutexes *... pointers) {
+                    ((key.count < lock_key_size ? void(key.mutexes[key.count++] = pointers) : void()), ...);
+                }, mutexes);
+                return key;
+            }
+
+            [[nodiscard]] std::size_t hash() const noexcept {
+                std::size_t hash = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    hash = (hash ^ (reinterpret_cast<std::uintptr_t>(mutexes[i]) >> 4)) * 0x9E3779B97F4A7C15ull;
+                }
+                return hash ^ (hash >> 32);
+            }
+
+            [[nodiscard]] bool operator==(lock_key const &) const noexcept = default;
+        };
+
+        using lock_histogram = relaxed_histogram;
+
+        struct lock_slot {
+            std::atomic<bool> used = false;
+            lock_key key;   // written by the owner before used is set
+            std::atomic<std::uint64_t> contended = 0;
+            std::atomic<std::uint64_t> try_attempts = 0;
+            std::atomic<std::uint64_t> try_failures = 0;
+            lock_histogram wait;
+            lock_histogram hold;
+
+            void record_acquisition(bool const was_contended, std::chrono::nanoseconds const wait_time) noexcept {
+                increase(contended, was_contended ? 1 : 0);
+                wait.add(static_cast<std::uint64_t>(std::max(wait_time.count(), std::int64_t{0})));
+            }
+
+            void record_try(bool const locked) noexcept {
+                increase(try_attempts, 1);
+                increase(try_failures, locked ? 0 : 1);
+            }
+
+            void record_hold(std::chrono::nanoseconds const hold_time) noexcept {
+                hold.add(static_cast<std::uint64_t>(std::max(hold_time.count(), std::int64_t{0})));
+            }
+
+            void add_to(lock_profile & profile) const noexcept {
+                profile.acquisitions += wait.add_to(profile.wait_histogram, profile.wait_total, profile.wait_max);
+                profile.holds += hold.add_to(profile.hold_histogram, profile.hold_total, profile.hold_max);
+                profile.contended += contended.load(std::memory_order_relaxed);
+                profile.try_attempts += try_attempts.load(std::memory_order_relaxed);
+                profile.try_failures += try_failures.load(std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * @brief Statistics of the calling thread: an open-addressing table of mutex sets,
+         * the sets which don't fit are counted together in the overflow slot
+         */
+        struct thread_lock_profile {
+            std::array<lock_slot, thread_lock_slots> slots;
+            lock_slot overflow;
+
+            [[nodiscard]] lock_slot & find(lock_key const & key) noexcept {
+                std::size_t const start = key.hash() % thread_lock_slots;
+                for (std::size_t i = 0; i < thread_lock_slots; ++i) {
+                    lock_slot & slot = slots[(start + i) % thread_lock_slots];
+                    if (!slot.used.load(std::memory_order_relaxed)) {
+                        slot.key = key;
+                        slot.used.store(true, std::memory_order_release);
+                        return slot;
+                    }
+                    if (slot.key == key) {
+                        return slot;
+                    }
+                }
+                return overflow;
+            }
+        };
+
+        /**
+         * @brief Profiles of the live threads and the merged statistics of the finished ones.
+         * Created on the first use and never destroyed, since threads may exit and detach their profiles after main returns
+         */
+        class lock_registry {
+        public:
+            [[nodiscard]] static lock_registry & instance() {
+                static lock_registry * const registry = new lock_registry;
+                return *registry;
+            }
+
+            void attach(thread_lock_profile const * profile) {
+                std::scoped_lock lock(m_mutex);
+                m_live.push_back(profile);
+            }
+
+            void detach(thread_lock_profile const * profile) {
+                std::scoped_lock lock(m_mutex);
+                merge(*profile, m_retired);
+                std::erase(m_live, profile);
+            }
+
+            [[nodiscard]] std::vector<lock_profile> snapshot() {
+                std::scoped_lock lock(m_mutex);
+                std::vector<lock_profile> profiles = m_retired;
+                for (thread_lock_profile const * profile : m_live) {
+                    merge(*profile, profiles);
+                }
+                return profiles;
+            }
+
+        private:
+            static void merge(thread_lock_profile const & thread_profile, std::vector<lock_profile> & profiles) {
+                auto merge_slot = [&profiles](lock_slot const & slot, std::vector<void const *> mutexes) {
+                    auto it = std::ranges::find(profiles, mutexes, &lock_profile::mutexes);
+                    if (it == profiles.end()) {
+                        profiles.push_back({.mutexes = std::move(mutexes)});
+                        it = std::prev(profiles.end());
+                    }
+                    slot.add_to(*it);
+                };
+
+                for (lock_slot const & slot : thread_profile.slots) {
+                    if (slot.used.load(std::memory_order_acquire)) {
+                        auto const first = slot.key.mutexes.begin();
+                        merge_slot(slot, std::vector<void const *>(first, first + static_cast<std::ptrdiff_t>(slot.key.count)));
+                    }
+                }
+                merge_slot(thread_profile.overflow, {});
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::vector<thread_lock_profile const *> m_live;
+            std::vector<lock_profile> m_retired;
+        };
+
+        /**
+         * @brief returns the statistics of the calling thread, registered on the first call and merged into the registry on thread exit
+         */
+        [[nodiscard]] inline thread_lock_profile & this_thread_lock_profile() {
+            struct holder {
+                holder() : registry(lock_registry::instance()) {
+                    registry.attach(profile.get());
+                }
+
+                ~holder() {
+                    registry.detach(profile.get());
+                }
+
+                lock_registry & registry;
+                std::unique_ptr<thread_lock_profile> const profile = std::make_unique<thread_lock_profile>();
+            };
+
+            thread_local holder holder;
+            return *holder.profile;
+        }
+
+#ifdef EON_MT_LOCK_PROFILING
+
+        /**
+         * @brief Measures the wait and hold times of one lock and records them to the calling thread's statistics.
+         * A lock first tries to take the mutexes to tell whether it was contended
+         */
+        class lock_probe {
+            using clock = std::chrono::steady_clock;
+
+        public:
+            template <typename Mutexes, typename TryLock, typename Lock>
+            void lock(Mutexes const & mutexes, TryLock && try_lock, Lock && lock) {
+                clock::time_point const start = clock::now();
+                bool const contended = !try_lock();
+                if (contended) {
+                    lock();
+                }
+                m_acquired = clock::now();
+                slot(mutexes).record_acquisition(contended, std::chrono::duration_cast<std::chrono::nanoseconds>(m_acquired - start));
+            }
+
+            template <typename Mutexes, typename TryLock>
+            [[nodiscard]] bool try_lock(Mutexes const & mutexes, TryLock && try_lock) {
+                bool const locked = try_lock();
+                lock_slot & slot = this->slot(mutexes);
+                slot.record_try(locked);
+                if (locked) {
+                    m_acquired = clock::now();
+                    slot.record_acquisition(false, std::chrono::nanoseconds{0});
+                }
+                return locked;
+            }
+
+            void adopt() noexcept {
+                m_acquired = clock::now();
+            }
+
+            template <typename Mutexes, typename Unlock>
+            void unlock(Mutexes const & mutexes, Unlock && unlock) {
+                clock::duration const held = clock::now() - m_acquired;
+                unlock();
+                slot(mutexes).record_hold(std::chrono::duration_cast<std::chrono::nanoseconds>(held));
+            }
+
+        private:
+            template <typename Mutexes>
+            [[nodiscard]] static lock_slot & slot(Mutexes const & mutexes) {
+                return this_thread_lock_profile().find(lock_key::make(mutexes));
+            }
+
+        private:
+            clock::time_point m_acquired;
+        };
+
+#else
+
+        /**
+         * @brief Profiling is disabled: just calls the lock operations
+         */
+        class lock_probe {
+        public:
+            template <typename Mutexes, typename TryLock, typename Lock>
+            void lock(Mutexes const &, TryLock &&, Lock && lock) {
+                lock();
+            }
+
+            template <typename Mutexes, typename TryLock>
+            [[nodiscard]] bool try_lock(Mutexes const &, TryLock && try_lock) {
+                return try_lock();
+            }
+
+            void adopt() const noexcept {}
+
+            template <typename Mutexes, typename Unlock>
+            void unlock(Mutexes const &, Unlock && unlock) {
+                unlock();
+            }
+        };
+
+#endif
+
+    }
+
+    /**
+     * @brief Contention statistics of eon::mt::unique_lock and eon::mt::shared_lock, collected when <b>EON_MT_LOCK_PROFILING</b> is defined
+     * (it must be defined the same way in every translation unit). Every thread records into its own histograms,
+     * which are only read here
+     */
+    class lock_profiler {
+    public:
+#ifdef EON_MT_LOCK_PROFILING
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        /**
+         * @brief returns the statistics of all the mutex sets, the set with the longest total wait first
+         */
+        [[nodiscard]] static std::vector<lock_profile> snapshot() {
+            std::vector<lock_profile> profiles = detail::lock_registry::instance().snapshot();
+            std::erase_if(profiles, [](lock_profile const & profile) { return profile.acquisitions == 0 && profile.try_attempts == 0; });
+            std::ranges::sort(profiles, std::ranges::greater{}, &lock_profile::wait_total);
+            return profiles;
+        }
+
+        /**
+         * @brief writes the <b>top</b> mutex sets with the longest total wait to <b>stream</b>
+         */
+        static void report(std::ostream & stream, std::size_t const top = 10) {
+            using microseconds = std::chrono::duration<double, std::micro>;
+
+            std::vector<lock_profile> const profiles = snapshot();
+            stream << "rank | mutexes | acquisitions | contended, % | try_lock failures, % | wait total, us | wait p99, us"
+                      " | wait max, us | hold mean, us | hold p99, us\n";
+
+            auto const percent = [](std::uint64_t const part, std::uint64_t const whole) {
+                return whole == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(whole);
+            };
+
+            std::ios_base::fmtflags const flags = stream.flags();
+            stream << std::fixed << std::setprecision(2);
+            for (std::size_t i = 0; i < std::min(top, profiles.size()); ++i) {
+                lock_profile const & profile = profiles[i];
+                stream << i + 1 << " | ";
+                if (profile.mutexes.empty()) {
+                    stream << "(other)";
+                }
+                for (std::size_t j = 0; j < profile.mutexes.size(); ++j) {
+                    stream << (j == 0 ? "" : ",") << profile.mutexes[j];
+                }
+
+                microseconds const hold_mean = profile.holds == 0 ? microseconds{0} : microseconds(profile.hold_total) / static_cast<double>(profile.holds);
+                stream << " | " << profile.acquisitions
+                       << " | " << percent(profile.contended, profile.acquisitions)
+                       << " | " << percent(profile.try_failures, profile.try_attempts)
+                       << " | " << microseconds(profile.wait_total).count()
+                       << " | " << microseconds(lock_profile::quantile(profile.wait_histogram, 0.99)).count()
+                       << " | " << microseconds(profile.wait_max).count()
+                       << " | " << hold_mean.count()
+                       << " | " << microseconds(lock_profile::quantile(profile.hold_histogram, 0.99)).count() << '\n';
+            }
+            stream.flags(flags);
+        }
+    };
+
+}
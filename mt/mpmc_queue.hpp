@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <bit>
+#include <span>
+#include <type_traits>
+
+#include <eon/mt/concurrency_info.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Lock-free bounded multi-producer/multi-consumer queue (D. Vyukov's ring buffer).
+     * Every cell carries a sequence counter telling whether it is ready for a producer or a consumer of the current lap,
+     * so producers and consumers synchronize only through the cells they claim
+     * @tparam T type of the elements
+     */
+    template <typename T>
+    requires (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+    class mpmc_queue {
+        struct alignas(cache_line_size) cell {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+
+            [[nodiscard]] T * value() noexcept {
+                return std::launder(reinterpret_cast<T *>(storage));
+            }
+        };
+
+    public:
+        /**
+         * @brief creates a queue which can hold at least <b>capacity</b> elements
+         * @param capacity rounded up to the nearest power of two
+         */
+        explicit mpmc_queue(std::size_t capacity)
+            : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+              m_cells(std::make_unique<cell[]>(m_mask + 1)) {
+            for (std::size_t i = 0; i <= m_mask; ++i) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_queue(mpmc_queue const &) = delete;
+        mpmc_queue & operator=(mpmc_queue const &) = delete;
+
+        ~mpmc_queue() {
+            std::size_t const enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            for (std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed); pos != enqueue_pos; ++pos) {
+                std::destroy_at(m_cells[pos & m_mask].value());
+            }
+        }
+
+        /**
+         * @brief constructs an element in place
+         * @return false if the queue is full
+         */
+        template <typename... Args>
+        requires (std::is_nothrow_constructible_v<T, Args...>)
+        [[nodiscard]] bool try_emplace(Args &&... args) {
+            std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            cell * c;
+
+            while (true) {
+                c = &m_cells[pos & m_mask];
+                std::size_t const sequence = c->sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+                if (diff == 0) {
+                    if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            std::construct_at(c->value(), std::forward<Args>(args)...);
+            c->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @return false if the queue is full, <b>value</b> is left untouched in this case
+         */
+        [[nodiscard]] bool try_push(T && value) {
+            return try_emplace(std::move(value));
+        }
+
+        /**
+         * @return false if the queue is full
+         */
+        [[nodiscard]] bool try_push(T const & value) requires (std::copy_constructible<T>) {
+            if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                return try_emplace(value);
+            }
+            else {
+                T copy(value);
+                return try_emplace(std::move(copy));
+            }
+        }
+
+        /**
+         * @brief moves the first elements of <b>values</b> to the queue claiming their cells with one CAS
+         * @return the number of moved elements, it's less than <b>values.size()</b> if there is not enough free space
+         */
+        [[nodiscard]] std::size_t try_push_bulk(std::span<T> values) {
+            std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            std::size_t count;
+
+            while (true) {
+                count = 0;
+                while (count < values.size() && count <= m_mask
+                       && m_cells[(pos + count) & m_mask].sequence.load(std::memory_order_acquire) == pos + count) {
+                    ++count;
+                }
+
+                if (count == 0) {
+                    std::size_t const sequence = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+                    if (values.empty() || static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos) < 0) {
+                        return 0;
+                    }
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+                else if (m_enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                cell & c = m_cells[(pos + i) & m_mask];
+                std::construct_at(c.value(), std::move(values[i]));
+                c.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief moves the oldest element to <b>value</b>
+         * @return false if the queue is empty
+         */
+        [[nodiscard]] bool try_pop(T & value) {
+            std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            cell * c;
+
+            while (true) {
+                c = &m_cells[pos & m_mask];
+                std::size_t const sequence = c->sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+                if (diff == 0) {
+                    if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            T * const stored = c->value();
+            value = std::move(*stored);
+            std::destroy_at(stored);
+            c->sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief returns the maximum number of elements
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return m_mask + 1;
+        }
+
+        /**
+         * @brief returns the number of elements. The result is approximate if the queue is being modified concurrently
+         */
+        [[nodiscard]] std::size_t size() const noexcept {
+            std::size_t const dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            std::size_t const enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+        }
+
+        /**
+         * @brief checks whether the queue is empty. The result is approximate if the queue is being modified concurrently
+         */
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+    private:
+        std::size_t const m_mask;
+        std::unique_ptr<cell[]> m_cells;
+
+        alignas(cache_line_size) std::atomic<std::size_t> m_enqueue_pos = 0;
+        alignas(cache_line_size) std::atomic<std::size_t> m_dequeue_pos = 0;
+    };
+
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <eon/mt/concurrency_info.hpp>
+
+namespace eon::mt {
+
+    namespace detail {
+
+        /**
+         * @brief tells the CPU that the calling thread is spinning (x86 <b>pause</b>, ARM <b>yield</b>)
+         */
+        inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+        /**
+         * @brief Exponential backoff for spin loops: every pause() spins twice as long as the previous one
+         * until the limit of spins is reached, after which the caller should park
+         */
+        class backoff {
+        public:
+            static constexpr unsigned max_pauses = 64;
+            static constexpr unsigned max_rounds = 10; // 1 + 2 + ... + 64 pauses, then 3 more rounds of 64
+
+            /**
+             * @brief spins for the current round
+             * @return false if the spin limit is reached
+             */
+            bool pause() noexcept {
+                if (m_round == max_rounds) {
+                    return false;
+                }
+
+                for (unsigned i = 0; i < m_pauses; ++i) {
+                    cpu_relax();
+                }
+                m_pauses = std::min(m_pauses * 2, max_pauses);
+                ++m_round;
+                return true;
+            }
+
+        private:
+            unsigned m_pauses = 1;
+            unsigned m_round = 0;
+        };
+
+        /**
+         * @brief returns the index of the shard of the calling thread: the CPU it first ran on, or a round-robin number
+         * if the platform doesn't tell the CPU. The index is fixed for the thread's lifetime
+         */
+        [[nodiscard]] inline std::size_t thread_shard() noexcept {
+            static std::atomic<std::size_t> next_shard = 0;
+            thread_local std::size_t const shard = [] {
+#ifdef __linux__
+                int const cpu = sched_getcpu();
+                if (cpu >= 0) {
+                    return static_cast<std::size_t>(cpu);
+                }
+#endif
+                return next_shard.fetch_add(1, std::memory_order_relaxed);
+            }();
+            return shard;
+        }
+
+    }
+
+    /**
+     * @brief Mutex which spins with exponential backoff for a short while and then parks on std::atomic::wait.
+     * Uncontended lock and unlock are a single atomic operation each, unlock makes a wake-up call only if someone is parked
+     */
+    class adaptive_mutex {
+        static constexpr std::uint32_t unlocked = 0;
+        static constexpr std::uint32_t locked = 1;
+        static constexpr std::uint32_t parked = 2; // locked and there may be parked threads
+
+    public:
+        adaptive_mutex() noexcept = default;
+
+        adaptive_mutex(adaptive_mutex const &) = delete;
+        adaptive_mutex & operator=(adaptive_mutex const &) = delete;
+
+        void lock() noexcept {
+            std::uint32_t expected = unlocked;
+            if (m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            for (detail::backoff backoff; backoff.pause();) {
+                expected = m_state.load(std::memory_order_relaxed);
+                if (expected == unlocked && m_state.compare_exchange_weak(expected, locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+
+            // whoever gets the mutex from now on can't tell if there are other parked threads, so it unlocks with a wake-up call
+            while (m_state.exchange(parked, std::memory_order_acquire) != unlocked) {
+                m_state.wait(parked, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] bool try_lock() noexcept {
+            std::uint32_t expected = unlocked;
+            return m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept {
+            if (m_state.exchange(unlocked, std::memory_order_release) == parked) {
+                m_state.notify_one();
+            }
+        }
+
+    private:
+        std::atomic<std::uint32_t> m_state = unlocked;
+    };
+
+    /**
+     * @brief Writer-preferring shared mutex: once a writer is waiting, new readers wait until all the waiting writers are done,
+     * so a steady stream of readers can't starve writers. Spins with exponential backoff before parking on std::atomic::wait.
+     * Parked threads are counted, so unlocking makes a wake-up call only if someone is parked.
+     * Holds up to 2^22 - 1 readers and 2^9 - 1 waiting writers at once
+     */
+    class shared_mutex {
+        static constexpr std::uint32_t writer = 1u << 31;
+        static constexpr std::uint32_t waiting_writer = 1u << 22;
+        static constexpr std::uint32_t waiting_writers_mask = writer - waiting_writer;
+        static constexpr std::uint32_t readers_mask = waiting_writer - 1;
+
+    public:
+        shared_mutex() noexcept = default;
+
+        shared_mutex(shared_mutex const &) = delete;
+        shared_mutex & operator=(shared_mutex const &) = delete;
+
+        void lock() noexcept {
+            if (try_lock()) {
+                return;
+            }
+
+            std::uint32_t state = m_state.fetch_add(waiting_writer, std::memory_order_relaxed) + waiting_writer;
+            detail::backoff backoff;
+            while (true) {
+                if ((state & (writer | readers_mask)) == 0) {
+                    if (m_state.compare_exchange_weak(state, (state - waiting_writer) | writer, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+
+                if (!backoff.pause()) {
+                    park(state);
+                }
+                state = m_state.load(std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] bool try_lock() noexcept {
+            std::uint32_t state = m_state.load(std::memory_order_relaxed);
+            return (state & (writer | readers_mask)) == 0
+                   && m_state.compare_exchange_strong(state, state | writer, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept {
+            m_state.fetch_and(~writer, std::memory_order_seq_cst);
+            if (m_parked.load(std::memory_order_seq_cst) != 0) {
+                m_state.notify_all();
+            }
+        }
+
+        void lock_shared() noexcept {
+            std::uint32_t state = m_state.load(std::memory_order_relaxed);
+            detail::backoff backoff;
+            while (true) {
+                if ((state & (writer | waiting_writers_mask)) == 0) {
+                    if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+
+                if (!backoff.pause()) {
+                    park(state);
+                }
+                state = m_state.load(std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] bool try_lock_shared() noexcept {
+            std::uint32_t state = m_state.load(std::memory_order_relaxed);
+            while ((state & (writer | waiting_writers_mask)) == 0) {
+                if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void unlock_shared() noexcept {
+            std::uint32_t const state = m_state.fetch_sub(1, std::memory_order_seq_cst);
+            if ((state & readers_mask) == 1 && (state & waiting_writers_mask) != 0 && m_parked.load(std::memory_order_seq_cst) != 0) {
+                m_state.notify_all();
+            }
+        }
+
+    private:
+        /**
+         * @brief sleeps while the state is <b>state</b>. The parked thread is counted before the state is checked
+         * and the unlocks check the count after changing the state, so either the thread sees the change or it is woken up
+         */
+        void park(std::uint32_t const state) noexcept {
+            m_parked.fetch_add(1, std::memory_order_seq_cst);
+            m_state.wait(state, std::memory_order_seq_cst);
+            m_parked.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::uint32_t> m_state = 0;
+        std::atomic<std::uint32_t> m_parked = 0;
+    };
+
+    /**
+     * @brief Reader-writer lock for read-mostly data. Readers count themselves in the shard of their CPU,
+     * each on its own cache line, so concurrent readers don't contend. A writer blocks new readers
+     * and waits for every shard to drain, which makes writing proportionally more expensive
+     */
+    class sharded_shared_mutex {
+        using shard_t = detail::padded<std::atomic<std::uint32_t>>;
+
+    public:
+        /**
+         * @brief creates the lock with <b>shards_count</b> reader shards
+         */
+        explicit sharded_shared_mutex(std::size_t shards_count = available())
+            : m_shards_count(std::max<std::size_t>(shards_count, 1)), m_shards(std::make_unique<shard_t[]>(m_shards_count)) {}
+
+        sharded_shared_mutex(sharded_shared_mutex const &) = delete;
+        sharded_shared_mutex & operator=(sharded_shared_mutex const &) = delete;
+
+        void lock() noexcept {
+            m_writers_mutex.lock();
+            m_writer.value.store(true, std::memory_order_seq_cst);
+
+            for (std::size_t i = 0; i < m_shards_count; ++i) {
+                std::atomic<std::uint32_t> & readers = m_shards[i].value;
+                detail::backoff backoff;
+                for (std::uint32_t count = readers.load(std::memory_order_seq_cst); count != 0; count = readers.load(std::memory_order_seq_cst)) {
+                    if (!backoff.pause()) {
+                        readers.wait(count, std::memory_order_seq_cst);
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] bool try_lock() noexcept {
+            if (!m_writers_mutex.try_lock()) {
+                return false;
+            }
+
+            m_writer.value.store(true, std::memory_order_seq_cst);
+            for (std::size_t i = 0; i < m_shards_count; ++i) {
+                if (m_shards[i].value.load(std::memory_order_seq_cst) != 0) {
+                    unlock();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void unlock() noexcept {
+            m_writer.value.store(false, std::memory_order_release);
+            m_writer.value.notify_all();
+            m_writers_mutex.unlock();
+        }
+
+        void lock_shared() noexcept {
+            std::atomic<std::uint32_t> & readers = shard();
+            while (true) {
+                readers.fetch_add(1, std::memory_order_seq_cst);
+                if (!m_writer.value.load(std::memory_order_seq_cst)) {
+                    return;
+                }
+
+                leave(readers);
+                detail::backoff backoff;
+                while (m_writer.value.load(std::memory_order_acquire)) {
+                    if (!backoff.pause()) {
+                        m_writer.value.wait(true, std::memory_order_acquire);
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] bool try_lock_shared() noexcept {
+            std::atomic<std::uint32_t> & readers = shard();
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_writer.value.load(std::memory_order_seq_cst)) {
+                return true;
+            }
+
+            leave(readers);
+            return false;
+        }
+
+        void unlock_shared() noexcept {
+            leave(shard());
+        }
+
+    private:
+        [[nodiscard]] std::atomic<std::uint32_t> & shard() const noexcept {
+            return m_shards[detail::thread_shard() % m_shards_count].value;
+        }
+
+        /**
+         * @brief removes a reader from <b>readers</b> and wakes the writer waiting for the shard to drain
+         */
+        void leave(std::atomic<std::uint32_t> & readers) const noexcept {
+            if (readers.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_writer.value.load(std::memory_order_seq_cst)) {
+                readers.notify_all();
+            }
+        }
+
+    private:
+        std::size_t const m_shards_count;
+        std::unique_ptr<shard_t[]> const m_shards;
+        detail::padded<std::atomic<bool>> m_writer{false};
+        adaptive_mutex m_writers_mutex;
+    };
+
+}
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+#include <ranges>
+#include <mutex>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+#include <eon/mt/algorithms.hpp>
+#include <eon/mt/thread_pool.hpp>
+#include <eon/mt/mpmc_queue.hpp>
+#include <eon/mt/event_count.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Defines how a stage of <b>eon::mt::pipeline</b> runs its items
+     */
+    enum class stage_mode {
+        serial_in_order,        ///< one item at a time in the order the source produced them
+        serial_out_of_order,    ///< one item at a time in any order
+        parallel                ///< any number of items at once
+    };
+
+    /**
+     * @brief Stage of <b>eon::mt::pipeline</b>: <b>fn</b> takes the result of the previous stage
+     */
+    template <typename Fn>
+    struct stage {
+        stage_mode mode;
+        Fn fn;
+    };
+
+    template <typename Fn>
+    stage(stage_mode, Fn) -> stage<Fn>;
+
+    /**
+     * @brief returns a pipeline source producing the elements of <b>rng</b>, which must outlive the pipeline
+     */
+    template <std::ranges::input_range Rng>
+    [[nodiscard]] auto from_range(Rng & rng) {
+        return [it = std::ranges::begin(rng), end = std::ranges::end(rng)]() mutable -> std::optional<std::ranges::range_value_t<Rng>> {
+            if (it == end) {
+                return std::nullopt;
+            }
+
+            std::optional<std::ranges::range_value_t<Rng>> value(*it);
+            ++it;
+            return value;
+        };
+    }
+
+    namespace detail {
+
+        template <typename In, typename... Fns>
+        struct stage_inputs : std::type_identity<std::tuple<>> {};
+
+        /**
+         * @brief tuple of the input types of the stages <b>Fn, Fns...</b> when the first one takes <b>In</b>
+         */
+        template <typename In, typename Fn, typename... Fns>
+        struct stage_inputs<In, Fn, Fns...> : std::type_identity<decltype(std::tuple_cat(
+            std::declval<std::tuple<In>>(),
+            std::declval<typename stage_inputs<std::invoke_result_t<Fn &, In &&>, Fns...>::type>()))> {};
+
+        template <typename Tuple>
+        struct nothrow_movable_items;
+
+        template <typename... Ts>
+        struct nothrow_movable_items<std::tuple<Ts...>> : std::bool_constant<(std::is_nothrow_move_constructible_v<Ts> && ...)> {};
+
+        template <typename T>
+        struct pipeline_item {
+            std::size_t sequence = 0;
+            std::optional<T> value;
+        };
+
+        /**
+         * @brief A stage with its input buffer. Parallel and out-of-order stages take items from a bounded lock-free queue,
+         * an in-order stage finds the next item in a ring indexed by the item's sequence number modulo the number of tokens.
+         * Neither can overflow as there are never more items in flight than tokens
+         */
+        template <typename In, typename Fn>
+        class pipeline_stage {
+            struct slot {
+                std::atomic<bool> full = false;
+                std::optional<In> value;
+            };
+
+        public:
+            pipeline_stage(stage<Fn> & stage, std::size_t const tokens)
+                : m_mode(stage.mode), m_fn(stage.fn), m_tokens(tokens), m_queue(m_mode == stage_mode::serial_in_order ? 1 : tokens),
+                  m_ring(m_mode == stage_mode::serial_in_order ? std::make_unique<slot[]>(tokens) : nullptr) {}
+
+            /**
+             * @brief takes the arguments as one tuple, so a tuple of stages, which can't be moved, can be constructed in place
+             */
+            explicit pipeline_stage(std::tuple<stage<Fn> &, std::size_t> const & args) : pipeline_stage(std::get<0>(args), std::get<1>(args)) {}
+
+            void push(std::size_t const sequence, In && value) noexcept {
+                if (m_mode == stage_mode::serial_in_order) {
+                    slot & target = m_ring[sequence % m_tokens];
+                    target.value.emplace(std::move(value));
+                    target.full.store(true, std::memory_order_release);
+                }
+                else {
+                    [[maybe_unused]] bool const pushed = m_queue.try_push({sequence, std::move(value)});
+                }
+            }
+
+            /**
+             * @brief runs the available items unless another thread runs this serial stage, passes the results to <b>emit</b>
+             * @return true if any item was run
+             */
+            template <typename Emit>
+            bool run(Emit && emit) {
+                switch (m_mode) {
+                    case stage_mode::parallel:
+                        return run_parallel(emit);
+                    case stage_mode::serial_out_of_order:
+                        return run_out_of_order(emit);
+                    default:
+                        return run_in_order(emit);
+                }
+            }
+
+        private:
+            template <typename Emit>
+            bool run_parallel(Emit & emit) {
+                pipeline_item<In> item;
+                if (!m_queue.try_pop(item)) {
+                    return false;
+                }
+
+                invoke(emit, item.sequence, std::move(*item.value));
+                return true;
+            }
+
+            /**
+             * @brief whoever releases the stage checks for items once more, so an item pushed while the stage was taken isn't stuck.
+             * The stage is taken and released with read-modify-writes, so the releasing thread sees the items
+             * of everyone who found it taken
+             */
+            template <typename Emit>
+            bool run_out_of_order(Emit & emit) {
+                bool ran = false;
+                while (!m_queue.empty()) {
+                    if (m_busy.exchange(true, std::memory_order_acq_rel)) {
+                        return ran;
+                    }
+
+                    pipeline_item<In> item;
+                    while (m_queue.try_pop(item)) {
+                        invoke(emit, item.sequence, std::move(*item.value));
+                        ran = true;
+                    }
+                    m_busy.exchange(false, std::memory_order_acq_rel);
+                }
+                return ran;
+            }
+
+            template <typename Emit>
+            bool run_in_order(Emit & emit) {
+                bool ran = false;
+                while (m_ring[m_next.load(std::memory_order_acquire) % m_tokens].full.load(std::memory_order_acquire)) {
+                    if (m_busy.exchange(true, std::memory_order_acq_rel)) {
+                        return ran;
+                    }
+
+                    std::size_t next = m_next.load(std::memory_order_relaxed);
+                    for (slot * current = &m_ring[next % m_tokens]; current->full.load(std::memory_order_acquire); current = &m_ring[next % m_tokens]) {
+                        In value = std::move(*current->value);
+                        current->value.reset();
+                        current->full.store(false, std::memory_order_relaxed);
+                        m_next.store(++next, std::memory_order_release);
+                        invoke(emit, next - 1, std::move(value));
+                        ran = true;
+                    }
+                    m_busy.exchange(false, std::memory_order_acq_rel);
+                }
+                return ran;
+            }
+
+            template <typename Emit>
+            void invoke(Emit & emit, std::size_t const sequence, In && value) {
+                if constexpr (std::is_void_v<std::invoke_result_t<Fn &, In &&>>) {
+                    std::invoke(m_fn, std::move(value));
+                    emit(sequence);
+                }
+                else {
+                    emit(sequence, std::invoke(m_fn, std::move(value)));
+                }
+            }
+
+        private:
+            stage_mode const m_mode;
+            Fn & m_fn;
+            std::size_t const m_tokens;
+            mpmc_queue<pipeline_item<In>> m_queue;
+            std::unique_ptr<slot[]> const m_ring;
+            std::atomic<std::size_t> m_next = 0;
+            std::atomic<bool> m_busy = false;
+        };
+
+        /**
+         * @brief State of one run of a pipeline. Runners take whatever work there is, the last stages first
+         * so the items in flight finish and free their tokens, and sleep on an event count when there is none.
+         * It is shared by the caller and the runners posted to the pool, a runner which starts after the run is over
+         * finds it stopped and returns without touching the source or the stages
+         */
+        template <typename Source, typename Inputs, typename... Fns>
+        class pipeline_run;
+
+        template <typename Source, typename... Ins, typename... Fns>
+        class pipeline_run<Source, std::tuple<Ins...>, Fns...> {
+            using value_t = std::tuple_element_t<0, std::tuple<Ins...>>;
+
+            static constexpr std::size_t stages_count = sizeof...(Fns);
+
+        public:
+            pipeline_run(Source & source, std::tuple<stage<Fns>...> & stages, std::size_t const tokens)
+                : pipeline_run(source, stages, tokens, std::index_sequence_for<Fns...>{}) {}
+
+            void run() {
+                m_active.fetch_add(1, std::memory_order_seq_cst);
+                while (!stopped()) {
+                    if (step()) {
+                        continue;
+                    }
+
+                    auto const key = m_event.prepare_wait();
+                    if (step()) {
+                        m_event.cancel_wait();
+                        continue;
+                    }
+                    if (stopped()) {
+                        m_event.cancel_wait();
+                        break;
+                    }
+                    m_event.wait(key);
+                }
+
+                if (m_active.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                    m_active.notify_all();
+                }
+            }
+
+            /**
+             * @brief waits until the run is stopped and no runner is inside a stage or the source. Runners still queued
+             * on the pool aren't waited for: they register before checking whether the run is stopped
+             */
+            void wait() const noexcept {
+                for (std::size_t active = m_active.load(std::memory_order_seq_cst); active != 0; active = m_active.load(std::memory_order_seq_cst)) {
+                    m_active.wait(active, std::memory_order_seq_cst);
+                }
+            }
+
+            /**
+             * @brief rethrows the first exception thrown by the source or a stage
+             */
+            void rethrow() const {
+                if (m_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+        private:
+            template <std::size_t... I>
+            pipeline_run(Source & source, std::tuple<stage<Fns>...> & stages, std::size_t const tokens, std::index_sequence<I...>)
+                : m_source(source), m_tokens(tokens), m_stages(std::tuple<stage<Fns> &, std::size_t>(std::get<I>(stages), tokens)...) {}
+
+            [[nodiscard]] bool stopped() const noexcept {
+                return m_failed.load(std::memory_order_seq_cst)
+                       || (m_source_done.load(std::memory_order_seq_cst) && m_in_flight.load(std::memory_order_seq_cst) == 0);
+            }
+
+            bool step() {
+                try {
+                    return [this]<std::size_t... I>(std::index_sequence<I...>) {
+                        return (run_stage<stages_count - 1 - I>() || ...) || generate();
+                    }(std::make_index_sequence<stages_count>{});
+                }
+                catch (...) {
+                    std::scoped_lock lock(m_exception_mutex);
+                    if (!m_exception) {
+                        m_exception = std::current_exception();
+                    }
+                    m_failed.store(true, std::memory_order_seq_cst);
+                    m_event.notify_all();
+                    return false;
+                }
+            }
+
+            template <std::size_t I>
+            bool run_stage() {
+                return std::get<I>(m_stages).run([this](std::size_t const sequence, auto &&... result) {
+                    if constexpr (I + 1 < stages_count) {
+                        std::get<I + 1>(m_stages).push(sequence, std::forward<decltype(result)>(result)...);
+                        m_event.notify_one();
+                    }
+                    else {
+                        finish_item();
+                    }
+                });
+            }
+
+            /**
+             * @brief takes the next item from the source if there is a free token and nobody else is taking one
+             */
+            bool generate() {
+                if (m_source_done.load(std::memory_order_relaxed) || m_in_flight.load(std::memory_order_relaxed) >= m_tokens
+                    || m_source_busy.exchange(true, std::memory_order_acq_rel)) {
+                    return false;
+                }
+
+                bool generated = false;
+                if (!m_source_done.load(std::memory_order_relaxed) && m_in_flight.load(std::memory_order_relaxed) < m_tokens) {
+                    std::optional<value_t> value;
+                    try {
+                        value = m_source();
+                    }
+                    catch (...) {
+                        m_source_busy.store(false, std::memory_order_release);
+                        throw;
+                    }
+
+                    if (value) {
+                        m_in_flight.fetch_add(1, std::memory_order_seq_cst);
+                        std::get<0>(m_stages).push(m_sequence++, std::move(*value));
+                        m_event.notify_one();
+                        generated = true;
+                    }
+                    else {
+                        m_source_done.store(true, std::memory_order_seq_cst);
+                        if (m_in_flight.load(std::memory_order_seq_cst) == 0) {
+                            m_event.notify_all();
+                        }
+                    }
+                }
+
+                m_source_busy.exchange(false, std::memory_order_acq_rel);
+                return generated;
+            }
+
+            /**
+             * @brief frees the token of an item which has passed the last stage
+             */
+            void finish_item() {
+                if (m_in_flight.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_source_done.load(std::memory_order_seq_cst)) {
+                    m_event.notify_all();
+                }
+                else {
+                    m_event.notify_one();
+                }
+            }
+
+        private:
+            Source & m_source;
+            std::size_t const m_tokens;
+            std::tuple<pipeline_stage<Ins, Fns>...> m_stages;
+
+            std::atomic<bool> m_source_busy = false;
+            std::atomic<bool> m_source_done = false;
+            std::size_t m_sequence = 0; // written only by the thread taking items from the source
+            std::atomic<std::size_t> m_in_flight = 0;
+
+            event_count m_event;
+            std::atomic<std::size_t> m_active = 0;  // runners inside run()
+            std::atomic<bool> m_failed = false;
+            std::mutex m_exception_mutex;
+            std::exception_ptr m_exception;
+        };
+
+    }
+
+    /**
+     * @brief Chain of stages run in parallel, like TBB's parallel_pipeline. <b>source</b> returns <b>std::optional</b>
+     * with the next item or std::nullopt when there are no more, and is called by one thread at a time. Every stage takes
+     * the result of the previous one, the last stage returns void. Items move between the stages through bounded lock-free
+     * queues, at most <b>max_tokens</b> items are in flight, so a slow stage holds back the source.
+     * Functions of parallel stages are called concurrently. The items must be nothrow move constructible
+     */
+    template <typename Source, typename... Fns>
+    requires (sizeof...(Fns) > 0)
+    class pipeline {
+        using value_t = typename std::invoke_result_t<Source &>::value_type;
+        using inputs_t = typename detail::stage_inputs<value_t, Fns...>::type;
+        using run_t = detail::pipeline_run<Source, inputs_t, Fns...>;
+
+        static_assert(std::is_void_v<std::invoke_result_t<std::tuple_element_t<sizeof...(Fns) - 1, std::tuple<Fns...>> &,
+                                                          std::tuple_element_t<sizeof...(Fns) - 1, inputs_t> &&>>,
+                      "the last stage of eon::mt::pipeline must return void");
+        static_assert(detail::nothrow_movable_items<inputs_t>::value,
+                      "the items passed between the stages of eon::mt::pipeline must be nothrow move constructible");
+
+    public:
+        explicit pipeline(Source source, stage<Fns>... stages) : m_source(std::move(source)), m_stages(std::move(stages)...) {}
+
+        /**
+         * @brief runs the pipeline on the workers of <b>pool</b> and the calling thread until the source has no more items.
+         * Returns once every item has passed the last stage, the runners still queued on the pool return as soon as they start,
+         * so a call from a worker of a busy pool doesn't wait for them. The first exception thrown by the source or a stage
+         * stops the run and is rethrown once no runner is inside a stage
+         */
+        template <task_pool Pool>
+        void run(Pool & pool, std::size_t const max_tokens) {
+            if (max_tokens == 0) {
+                throw std::invalid_argument("eon::mt::pipeline: max_tokens must be positive");
+            }
+
+            auto const run = std::make_shared<run_t>(m_source, m_stages, max_tokens);
+            std::size_t const runners_count = std::min<std::size_t>(pool.size(), max_tokens);
+
+            std::vector<std::function<void()>> runners(runners_count, [run] {
+                run->run();
+            });
+            if (!runners.empty()) {
+                pool.post_bulk(runners);
+            }
+
+            run->run();
+            run->wait();
+            run->rethrow();
+        }
+
+        /**
+         * @brief runs the pipeline on eon::mt::default_pool()
+         */
+        void run(std::size_t const max_tokens) {
+            run(default_pool(), max_tokens);
+        }
+
+    private:
+        Source m_source;
+        std::tuple<stage<Fns>...> m_stages;
+    };
+
+    template <typename Source, typename... Fns>
+    pipeline(Source, stage<Fns>...) -> pipeline<Source, Fns...>;
+
+}
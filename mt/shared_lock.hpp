@@ -0,0 +1,116 @@
+#pragma once
+
+#include <tuple>
+#include <mutex>
+#include <system_error>
+
+#include <eon/mt/unique_lock.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Like <b>std::shared_lock</b> but for multiple shared mutexes. They are locked one by one in the order
+     * of their addresses, so locks over overlapping sets of mutexes don't deadlock
+     */
+    template <typename... SharedMutexes>
+    requires (sizeof...(SharedMutexes) > 0)
+    class shared_lock {
+    public:
+        [[nodiscard]] explicit shared_lock(SharedMutexes &... mutexes) : m_mutexes(std::addressof(mutexes)...) {
+            lock_impl();
+        }
+
+        [[nodiscard]] explicit shared_lock(std::adopt_lock_t, SharedMutexes &... mutexes) noexcept : m_mutexes(std::addressof(mutexes)...), m_owns(true) {
+            m_probe.adopt();
+        }
+
+        explicit shared_lock(std::defer_lock_t, SharedMutexes &... mutexes) noexcept : m_mutexes(std::addressof(mutexes)...), m_owns(false) {}
+
+        [[nodiscard]] explicit shared_lock(std::try_to_lock_t, SharedMutexes &... mutexes): m_mutexes(std::addressof(mutexes)...) {
+            try_lock_impl();
+        }
+
+        [[nodiscard]] shared_lock(shared_lock && other) noexcept : m_mutexes(other.m_mutexes), m_owns(other.m_owns), m_probe(other.m_probe) {
+            other.m_owns = false;
+        }
+
+        shared_lock & operator=(shared_lock && other) noexcept {
+            shared_lock{std::move(other)}.swap(*this);
+            return *this;
+        }
+
+        ~shared_lock() {
+            if (m_owns) {
+                unlock_impl();
+            }
+        }
+
+        void lock() {
+            validate_lock();
+            lock_impl();
+        }
+
+        [[nodiscard]] bool try_lock() {
+            validate_lock();
+            try_lock_impl();
+            return m_owns;
+        }
+
+        void unlock() {
+            if (!m_owns) {
+                throw std::system_error(std::make_error_code(std::errc::operation_not_permitted));
+            }
+
+            unlock_impl();
+            m_owns = false;
+        }
+
+        [[nodiscard]] bool owns_lock() const noexcept {
+            return m_owns;
+        }
+
+        explicit operator bool() const noexcept {
+            return m_owns;
+        }
+
+        void swap(shared_lock & other) noexcept {
+            std::swap(m_mutexes, other.m_mutexes);
+            std::swap(m_owns, other.m_owns);
+            std::swap(m_probe, other.m_probe);
+        }
+
+    private:
+        void validate_lock() const {
+            if (m_owns) {
+                throw std::system_error(std::make_error_code(std::errc::resource_deadlock_would_occur));
+            }
+        }
+
+        [[nodiscard]] detail::address_ordered_mutexes<true, sizeof...(SharedMutexes)> ordered() const noexcept {
+            return std::apply([](SharedMutexes *... mutexes) {
+                return detail::address_ordered_mutexes<true, sizeof...(SharedMutexes)>(mutexes...);
+            }, m_mutexes);
+        }
+
+        void lock_impl() {
+            m_probe.lock(m_mutexes, [this] { return ordered().try_lock(); }, [this] { ordered().lock(); });
+            m_owns = true;
+        }
+
+        void try_lock_impl() {
+            m_owns = m_probe.try_lock(m_mutexes, [this] { return ordered().try_lock(); });
+        }
+
+        void unlock_impl() {
+            m_probe.unlock(m_mutexes, [this] {
+                std::apply([](SharedMutexes *... mutexes) { (..., mutexes->unlock_shared()); }, m_mutexes);
+            });
+        }
+
+    private:
+        std::tuple<SharedMutexes *...> m_mutexes;
+        bool m_owns;
+        [[no_unique_address]] detail::lock_probe m_probe;
+    };
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstddef>
+#include <utility>
+
+#include <eon/mt/concurrency_info.hpp>
+
+namespace eon::mt::detail {
+
+    /**
+     * @brief Thread-safe allocator of small blocks grouped by size classes.
+     * Freed blocks are pushed to a lock-free list and reused by later allocations, so once warmed up it doesn't call malloc.
+     * Blocks bigger than the largest size class come from operator new.
+     * The allocator is reference counted: it is destroyed when its owner has released it and all its blocks are deallocated
+     */
+    class slab_allocator {
+        static constexpr std::array<std::size_t, 3> size_classes{64, 128, 256};
+        static constexpr std::size_t blocks_per_chunk = 64;
+
+        struct free_block {
+            free_block * next;
+        };
+
+        struct alignas(cache_line_size) size_class {
+            std::mutex mutex;
+            free_block * free = nullptr;
+            std::atomic<free_block *> returned = nullptr;
+            std::vector<std::unique_ptr<std::byte[]>> chunks;
+        };
+
+        slab_allocator() = default;
+
+    public:
+        struct deleter {
+            void operator()(slab_allocator * allocator) const noexcept {
+                allocator->release();
+            }
+        };
+
+        using handle = std::unique_ptr<slab_allocator, deleter>;
+
+        static constexpr std::size_t max_block_size = size_classes.back();
+
+        [[nodiscard]] static handle make() {
+            return handle(new slab_allocator);
+        }
+
+        slab_allocator(slab_allocator const &) = delete;
+        slab_allocator & operator=(slab_allocator const &) = delete;
+
+        /**
+         * @brief allocates <b>size</b> bytes aligned to alignof(std::max_align_t)
+         */
+        [[nodiscard]] void * allocate(std::size_t const size) {
+            std::size_t const index = size_class_index(size);
+            if (index == size_classes.size()) {
+                return ::operator new(size);
+            }
+
+            size_class & cls = m_classes[index];
+            std::scoped_lock lock(cls.mutex);
+
+            if (cls.free == nullptr) {
+                // the whole list is taken at once, so popping from it can't suffer from ABA
+                cls.free = cls.returned.exchange(nullptr, std::memory_order_acquire);
+            }
+            if (cls.free == nullptr) {
+                add_chunk(cls, size_classes[index]);
+            }
+
+            m_refs.fetch_add(1, std::memory_order_relaxed);
+            return std::exchange(cls.free, cls.free->next);
+        }
+
+        /**
+         * @brief returns the block of <b>size</b> bytes previously allocated by <b>allocate(size)</b>
+         */
+        void deallocate(void * ptr, std::size_t const size) noexcept {
+            std::size_t const index = size_class_index(size);
+            if (index == size_classes.size()) {
+                ::operator delete(ptr);
+                return;
+            }
+
+            size_class & cls = m_classes[index];
+            auto * const block = static_cast<free_block *>(ptr);
+            block->next = cls.returned.load(std::memory_order_relaxed);
+            while (!cls.returned.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {}
+
+            release();
+        }
+
+    private:
+        [[nodiscard]] static constexpr std::size_t size_class_index(std::size_t const size) noexcept {
+            std::size_t index = 0;
+            while (index < size_classes.size() && size_classes[index] < size) {
+                ++index;
+            }
+            return index;
+        }
+
+        static void add_chunk(size_class & cls, std::size_t const block_size) {
+            auto & chunk = cls.chunks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(block_size * blocks_per_chunk));
+            for (std::size_t i = blocks_per_chunk; i-- > 0;) {
+                auto * const block = ::new (chunk.get() + i * block_size) free_block{cls.free};
+                cls.free = block;
+            }
+        }
+
+        void release() noexcept {
+            if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+    private:
+        std::array<size_class, size_classes.size()> m_classes;
+        std::atomic<std::size_t> m_refs = 1;
+    };
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+namespace eon::mt {
+
+    /**
+     * @brief Move-only <b>void()</b> callable wrapper which keeps callables of up to <b>Capacity</b> bytes
+     * in an inline buffer and allocates bigger ones on the heap
+     * @tparam Capacity size of the inline buffer
+     */
+    template <std::size_t Capacity>
+    requires (Capacity >= sizeof(void *))
+    class basic_small_task {
+        struct vtable {
+            void (*invoke)(void *);
+            void (*move)(void * dst, void * src) noexcept;
+            void (*destroy)(void *) noexcept;
+        };
+
+        template <typename Fn>
+        static constexpr bool is_stored_inline = sizeof(Fn) <= Capacity
+                                                 && alignof(Fn) <= alignof(std::max_align_t)
+                                                 && std::is_nothrow_move_constructible_v<Fn>;
+
+        template <typename Fn>
+        static constexpr vtable inline_vtable {
+            [](void * storage) { std::invoke(*static_cast<Fn *>(storage)); },
+            [](void * dst, void * src) noexcept {
+                std::construct_at(static_cast<Fn *>(dst), std::move(*static_cast<Fn *>(src)));
+                std::destroy_at(static_cast<Fn *>(src));
+            },
+            [](void * storage) noexcept { std::destroy_at(static_cast<Fn *>(storage)); }
+        };
+
+        template <typename Fn>
+        static constexpr vtable heap_vtable {
+            [](void * storage) { std::invoke(**static_cast<Fn **>(storage)); },
+            [](void * dst, void * src) noexcept { *static_cast<Fn **>(dst) = *static_cast<Fn **>(src); },
+            [](void * storage) noexcept { delete *static_cast<Fn **>(storage); }
+        };
+
+    public:
+        static constexpr std::size_t capacity = Capacity;
+
+        basic_small_task() noexcept = default;
+
+        template <typename Fn>
+        requires (!std::same_as<std::remove_cvref_t<Fn>, basic_small_task> && std::is_invocable_v<std::decay_t<Fn> &>)
+        basic_small_task(Fn && fn) {
+            using fn_t = std::decay_t<Fn>;
+
+            if constexpr (is_stored_inline<fn_t>) {
+                std::construct_at(reinterpret_cast<fn_t *>(m_storage), std::forward<Fn>(fn));
+                m_vtable = &inline_vtable<fn_t>;
+            }
+            else {
+                *reinterpret_cast<fn_t **>(m_storage) = new fn_t(std::forward<Fn>(fn));
+                m_vtable = &heap_vtable<fn_t>;
+            }
+        }
+
+        basic_small_task(basic_small_task && other) noexcept : m_vtable(std::exchange(other.m_vtable, nullptr)) {
+            if (m_vtable != nullptr) {
+                m_vtable->move(m_storage, other.m_storage);
+            }
+        }
+
+        basic_small_task & operator=(basic_small_task && other) noexcept {
+            if (this != &other) {
+                reset();
+                m_vtable = std::exchange(other.m_vtable, nullptr);
+                if (m_vtable != nullptr) {
+                    m_vtable->move(m_storage, other.m_storage);
+                }
+            }
+            return *this;
+        }
+
+        basic_small_task(basic_small_task const &) = delete;
+        basic_small_task & operator=(basic_small_task const &) = delete;
+
+        ~basic_small_task() {
+            reset();
+        }
+
+        void operator()() {
+            m_vtable->invoke(m_storage);
+        }
+
+        explicit operator bool() const noexcept {
+            return m_vtable != nullptr;
+        }
+
+        /**
+         * @brief destroys the stored callable
+         */
+        void reset() noexcept {
+            if (m_vtable != nullptr) {
+                m_vtable->destroy(m_storage);
+                m_vtable = nullptr;
+            }
+        }
+
+    private:
+        alignas(std::max_align_t) std::byte m_storage[Capacity];
+        vtable const * m_vtable = nullptr;
+    };
+
+    /**
+     * @brief basic_small_task which occupies one cache line on common 64-bit platforms
+     */
+    using small_task = basic_small_task<6 * sizeof(void *)>;
+
+}
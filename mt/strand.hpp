@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <utility>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+#include <eon/mt/concurrency_info.hpp>
+#include <eon/mt/small_task.hpp>
+#include <eon/mt/slab_allocator.hpp>
+#include <eon/mt/mutex.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Key of related tasks, e.g. a session id. Tasks with the same key run one at a time in the order they were added
+     */
+    struct affinity_key {
+        std::size_t value;
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Serial queue of tasks. Producers push without locks (Vyukov's multi-producer single-consumer queue),
+         * the producer which finds the strand idle schedules one drain, which takes the tasks in order until there are none.
+         * Nodes come from the pool's slab allocator, which the caller passes to every operation
+         */
+        class alignas(cache_line_size) strand {
+            struct node {
+                small_task task;
+                std::atomic<node *> next = nullptr;
+            };
+
+        public:
+            strand() noexcept = default;
+
+            strand(strand const &) = delete;
+            strand & operator=(strand const &) = delete;
+
+            /**
+             * @return true if the strand was idle and the caller must schedule a drain
+             */
+            [[nodiscard]] bool push(slab_allocator & allocator, small_task task) {
+                link(make_node(allocator, std::move(task)));
+                return m_pending.fetch_add(1, std::memory_order_acq_rel) == 0;
+            }
+
+            /**
+             * @brief pushes all the <b>tasks</b> in order
+             * @return true if the strand was idle and the caller must schedule a drain
+             */
+            [[nodiscard]] bool push_bulk(slab_allocator & allocator, std::span<small_task> tasks) {
+                if (tasks.empty()) {
+                    return false;
+                }
+
+                for (small_task & task : tasks) {
+                    link(make_node(allocator, std::move(task)));
+                }
+                return m_pending.fetch_add(tasks.size(), std::memory_order_acq_rel) == 0;
+            }
+
+            /**
+             * @brief runs up to <b>max_tasks</b> tasks, must not run concurrently with another drain
+             * @return true if there are more tasks and the caller must schedule the drain again
+             */
+            [[nodiscard]] bool drain(slab_allocator & allocator, std::size_t const max_tasks) {
+                for (std::size_t i = 0; i < max_tasks; ++i) {
+                    small_task task = take(allocator);
+                    task();
+                    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * @brief drops the queued tasks, must not run concurrently with push or drain
+             */
+            void clear(slab_allocator & allocator) noexcept {
+                while (node * const next = m_tail->next.load(std::memory_order_acquire)) {
+                    next->task.reset();
+                    free_node(allocator, std::exchange(m_tail, next));
+                }
+                m_pending.store(0, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief frees the last taken node, must be called once the strand is no longer used
+             */
+            void release(slab_allocator & allocator) noexcept {
+                clear(allocator);
+                free_node(allocator, std::exchange(m_tail, &m_stub));
+                m_stub.next.store(nullptr, std::memory_order_relaxed);
+                m_head.store(&m_stub, std::memory_order_relaxed);
+            }
+
+        private:
+            [[nodiscard]] static node * make_node(slab_allocator & allocator, small_task task) {
+                return ::new (allocator.allocate(sizeof(node))) node{std::move(task)};
+            }
+
+            void free_node(slab_allocator & allocator, node * const n) const noexcept {
+                if (n != &m_stub) {
+                    std::destroy_at(n);
+                    allocator.deallocate(n, sizeof(node));
+                }
+            }
+
+            void link(node * const n) noexcept {
+                node * const prev = m_head.exchange(n, std::memory_order_acq_rel);
+                prev->next.store(n, std::memory_order_release);
+            }
+
+            /**
+             * @brief takes the oldest task. It's known to be pushed, but its producer may be still linking it
+             */
+            [[nodiscard]] small_task take(slab_allocator & allocator) noexcept {
+                node * next = m_tail->next.load(std::memory_order_acquire);
+                while (next == nullptr) {
+                    cpu_relax();
+                    next = m_tail->next.load(std::memory_order_acquire);
+                }
+
+                small_task task = std::move(next->task);
+                free_node(allocator, std::exchange(m_tail, next));
+                return task;
+            }
+
+        private:
+            std::atomic<std::size_t> m_pending = 0;
+            std::atomic<node *> m_head = &m_stub;
+            node * m_tail = &m_stub;    // the last taken node, its task is empty
+            node m_stub;
+        };
+
+        /**
+         * @brief Fixed set of strands, keys are spread over them, so different keys may share a strand
+         */
+        class strand_table {
+        public:
+            static constexpr std::size_t size = 128;
+            static_assert(std::has_single_bit(size));
+
+            /**
+             * @brief the longest run of one strand before it's rescheduled, so a busy key doesn't hold a worker forever
+             */
+            static constexpr std::size_t drain_batch = 64;
+
+            explicit strand_table(slab_allocator & allocator) : m_allocator(allocator), m_strands(std::make_unique<strand[]>(size)) {}
+
+            strand_table(strand_table const &) = delete;
+            strand_table & operator=(strand_table const &) = delete;
+
+            ~strand_table() {
+                for (std::size_t i = 0; i < size; ++i) {
+                    m_strands[i].release(m_allocator);
+                }
+            }
+
+            /**
+             * @brief mixes all the bits of the key (splitmix64 finalizer) and takes the top ones, so structured keys
+             * such as pointers or multiples of the table size still spread over the strands
+             */
+            [[nodiscard]] static std::size_t slot(affinity_key const key) noexcept {
+                auto hash = static_cast<std::uint64_t>(key.value);
+                hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+                hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+                hash ^= hash >> 31;
+                return static_cast<std::size_t>(hash >> (64 - std::countr_zero(size)));
+            }
+
+            [[nodiscard]] bool push(std::size_t const slot, small_task task) {
+                return m_strands[slot].push(m_allocator, std::move(task));
+            }
+
+            [[nodiscard]] bool push_bulk(std::size_t const slot, std::span<small_task> tasks) {
+                return m_strands[slot].push_bulk(m_allocator, tasks);
+            }
+
+            [[nodiscard]] bool drain(std::size_t const slot) {
+                return m_strands[slot].drain(m_allocator, drain_batch);
+            }
+
+            void clear() noexcept {
+                for (std::size_t i = 0; i < size; ++i) {
+                    m_strands[i].clear(m_allocator);
+                }
+            }
+
+        private:
+            slab_allocator & m_allocator;
+            std::unique_ptr<strand[]> const m_strands;
+        };
+
+    }
+
+}
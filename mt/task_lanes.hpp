@@ -0,0 +1,213 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <cstdint>
+
+namespace eon::mt {
+
+    /**
+     * @brief Priority class of a task, every class has its own lane in the pool's queue
+     */
+    enum class priority {
+        high,
+        normal,
+        low
+    };
+
+    inline constexpr std::size_t priorities_count = 3;
+
+    /**
+     * @brief Defines how workers choose the lane to take the next task from
+     */
+    enum class lane_selection {
+        strict,     ///< the highest non-empty lane, a lower lane is served once it has been skipped <b>starvation_limit</b> times
+        weighted    ///< non-empty lanes are served in proportion to their weights (smooth weighted round-robin)
+    };
+
+    struct lane_options {
+        lane_selection selection = lane_selection::strict;
+        std::array<unsigned, priorities_count> weights{8, 4, 1};
+        unsigned starvation_limit = 64; ///< 0 disables starvation protection of the strict selection
+    };
+
+    using deadline_clock = std::chrono::steady_clock;
+
+    inline constexpr std::size_t any_node = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Scheduling attributes of a task
+     */
+    struct task_info {
+        mt::priority priority = mt::priority::normal;
+        deadline_clock::time_point deadline = deadline_clock::time_point::max();
+        std::size_t node = any_node; ///< NUMA node whose workers should run the task, see eon::mt::placement
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Lanes of tasks, one per priority class. Tasks with a deadline are taken from a lane earliest deadline first
+         * and before the tasks without one, the others are taken in FIFO order.
+         * Not thread-safe except for depth(), which may be read without the owner's lock
+         */
+        template <typename Task>
+        class task_lanes {
+            struct dated_task {
+                deadline_clock::time_point deadline;
+                std::uint64_t sequence;
+                Task task;
+
+                [[nodiscard]] bool operator>(dated_task const & other) const noexcept {
+                    return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+                }
+            };
+
+            struct lane {
+                std::deque<Task> tasks;
+                std::vector<dated_task> dated; // min-heap by deadline
+
+                [[nodiscard]] bool empty() const noexcept {
+                    return tasks.empty() && dated.empty();
+                }
+            };
+
+        public:
+            void push(Task task, task_info const & info) {
+                auto const index = static_cast<std::size_t>(info.priority);
+                lane & ln = m_lanes[index];
+
+                if (info.deadline == deadline_clock::time_point::max()) {
+                    ln.tasks.push_back(std::move(task));
+                }
+                else {
+                    ln.dated.push_back({info.deadline, m_sequence++, std::move(task)});
+                    std::ranges::push_heap(ln.dated, std::greater{});
+                }
+                added(index, 1);
+            }
+
+            template <std::ranges::input_range Rng>
+            void push_bulk(Rng && tasks, mt::priority const priority = mt::priority::normal) {
+                auto const index = static_cast<std::size_t>(priority);
+                std::size_t const old_size = m_lanes[index].tasks.size();
+                std::ranges::move(tasks, std::back_inserter(m_lanes[index].tasks));
+                added(index, m_lanes[index].tasks.size() - old_size);
+            }
+
+            [[nodiscard]] bool pop(Task & task) {
+                if (m_size == 0) {
+                    return false;
+                }
+
+                std::size_t const index = m_options.selection == lane_selection::strict ? select_strict() : select_weighted();
+                lane & ln = m_lanes[index];
+
+                if (!ln.dated.empty()) {
+                    std::ranges::pop_heap(ln.dated, std::greater{});
+                    task = std::move(ln.dated.back().task);
+                    ln.dated.pop_back();
+                }
+                else {
+                    task = std::move(ln.tasks.front());
+                    ln.tasks.pop_front();
+                }
+
+                --m_size;
+                m_depths[index].fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return m_size == 0;
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return m_size;
+            }
+
+            /**
+             * @brief returns the number of tasks in the lane of <b>priority</b>. Can be called concurrently with modifications
+             */
+            [[nodiscard]] std::size_t depth(mt::priority const priority) const noexcept {
+                return m_depths[static_cast<std::size_t>(priority)].load(std::memory_order_relaxed);
+            }
+
+            void set_options(lane_options const & options) noexcept {
+                m_options = options;
+                m_skipped.fill(0);
+                m_current.fill(0);
+            }
+
+            void clear() {
+                for (std::size_t i = 0; i < priorities_count; ++i) {
+                    m_lanes[i] = lane{};
+                    m_depths[i].store(0, std::memory_order_relaxed);
+                }
+                m_size = 0;
+            }
+
+        private:
+            void added(std::size_t const index, std::size_t const count) noexcept {
+                m_size += count;
+                m_depths[index].fetch_add(count, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] std::size_t select_strict() noexcept {
+                auto const first = static_cast<std::size_t>(std::ranges::find_if(m_lanes, [](lane const & ln) { return !ln.empty(); }) - m_lanes.begin());
+                std::size_t chosen = first;
+
+                if (m_options.starvation_limit != 0) {
+                    for (std::size_t i = first + 1; i < priorities_count; ++i) {
+                        if (!m_lanes[i].empty() && ++m_skipped[i] > m_options.starvation_limit && m_skipped[i] > m_skipped[chosen]) {
+                            chosen = i;
+                        }
+                    }
+                }
+
+                m_skipped[chosen] = 0;
+                return chosen;
+            }
+
+            [[nodiscard]] std::size_t select_weighted() noexcept {
+                std::int64_t total = 0;
+                std::size_t chosen = priorities_count;
+
+                for (std::size_t i = 0; i < priorities_count; ++i) {
+                    if (m_lanes[i].empty()) {
+                        continue;
+                    }
+
+                    auto const weight = static_cast<std::int64_t>(std::max(m_options.weights[i], 1u));
+                    m_current[i] += weight;
+                    total += weight;
+                    if (chosen == priorities_count || m_current[i] > m_current[chosen]) {
+                        chosen = i;
+                    }
+                }
+
+                m_current[chosen] -= total;
+                return chosen;
+            }
+
+        private:
+            std::array<lane, priorities_count> m_lanes;
+            std::array<std::atomic<std::size_t>, priorities_count> m_depths{};
+            std::size_t m_size = 0;
+            std::uint64_t m_sequence = 0;
+
+            lane_options m_options;
+            std::array<unsigned, priorities_count> m_skipped{};
+            std::array<std::int64_t, priorities_count> m_current{};
+        };
+
+    }
+
+}
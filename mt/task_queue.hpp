@@ -0,0 +1,625 @@
+#pragma once
+
+#include <deque>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <stop_token>
+#include <thread>
+#include <span>
+
+#include <eon/mt/concurrency_info.hpp>
+#include <eon/mt/mpmc_queue.hpp>
+#include <eon/mt/event_count.hpp>
+#include <eon/mt/task_lanes.hpp>
+
+namespace eon::mt {
+
+    /**
+     * @brief Defines how <b>eon::mt::thread_pool</b> distributes tasks among its workers
+     */
+    enum class scheduling {
+        shared_queue,   ///< all the workers take tasks from one mutex-protected queue with priority lanes
+        work_stealing,  ///< every worker owns a deque, idle workers steal from the others
+        lock_free       ///< all the workers take tasks from one bounded lock-free queue and sleep on std::atomic::wait
+    };
+
+    namespace detail {
+
+        /**
+         * @brief wakes <b>count</b> of <b>sleeping</b> workers, all of them with one call if there are not enough sleeping ones
+         */
+        inline void wake(std::condition_variable_any & cv, std::size_t const count, std::size_t const sleeping) {
+            if (count >= sleeping) {
+                cv.notify_all();
+                return;
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                cv.notify_one();
+            }
+        }
+
+
+        /**
+         * @brief One queue with priority lanes shared by all the workers
+         */
+        template <typename Task>
+        class shared_task_queue {
+        public:
+            struct worker_handle {};
+
+            void push(Task task, task_info const & info = {}) {
+                {
+                    std::scoped_lock lock(m_mutex);
+                    m_tasks.push(std::move(task), info);
+                }
+                m_cv.notify_one();
+            }
+
+            /**
+             * @brief pushes all the <b>tasks</b> under one lock and wakes up to <b>tasks.size()</b> workers
+             */
+            void push_bulk(std::span<Task> tasks) {
+                std::size_t sleeping;
+                {
+                    std::scoped_lock lock(m_mutex);
+                    m_tasks.push_bulk(tasks);
+                    sleeping = m_sleeping;
+                }
+                wake(m_cv, tasks.size(), sleeping);
+            }
+
+            /**
+             * @brief blocks until a task is available, the worker is asked to exit or stop is requested and there are no tasks
+             * @return false if the worker must exit
+             */
+            template <typename ExitPred>
+            [[nodiscard]] bool pop(Task & task, std::stop_token stop_token, ExitPred should_exit) {
+                std::unique_lock lock(m_mutex);
+                ++m_sleeping;
+                bool const has_tasks = m_cv.wait(lock, stop_token, [this] { return !m_tasks.empty(); });
+                --m_sleeping;
+
+                if (should_exit() || !has_tasks) {
+                    return false;
+                }
+
+                return m_tasks.pop(task);
+            }
+
+            [[nodiscard]] worker_handle worker(std::size_t) const noexcept {
+                return {};
+            }
+
+            void attach_worker(worker_handle) noexcept {}
+
+            void add_workers(std::size_t) {}
+
+            void remove_workers(std::size_t) {}
+
+            void swap_workers(std::size_t, std::size_t) noexcept {}
+
+            void notify_all() {
+                m_cv.notify_all();
+            }
+
+            void clear() {
+                std::scoped_lock lock(m_mutex);
+                m_tasks.clear();
+            }
+
+            [[nodiscard]] std::size_t depth(priority const priority) const noexcept {
+                return m_tasks.depth(priority);
+            }
+
+            void set_lane_options(lane_options const & options) {
+                std::scoped_lock lock(m_mutex);
+                m_tasks.set_options(options);
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable_any m_cv;
+            task_lanes<Task> m_tasks;
+            std::size_t m_sleeping = 0;
+        };
+
+
+        /**
+         * @brief Per-worker deques with a global injection queue.
+         * Workers push and pop their own tasks at the back (LIFO), idle workers steal from the front (FIFO),
+         * tasks from outside the pool and tasks with a priority other than normal or a deadline go to the injection queue,
+         * which has priority lanes. High priority injected tasks are taken before the worker's own ones
+         */
+        template <typename Task>
+        class work_stealing_task_queue {
+            /**
+             * @brief Deque of one worker, shared with the worker's thread, so it outlives the removal until the thread exits.
+             * A removed deque is empty and takes no more tasks
+             */
+            struct alignas(cache_line_size) local_queue {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                std::atomic<std::size_t> size = 0;
+                bool removed = false;
+                std::size_t index = 0;  // current position in m_locals, guarded by m_locals_mutex
+            };
+
+            struct worker_info {
+                work_stealing_task_queue * owner = nullptr;
+                std::shared_ptr<local_queue> queue;
+            };
+
+        public:
+            using worker_handle = std::shared_ptr<local_queue>;
+
+            void push(Task task, task_info const & info = {}) {
+                local_queue * const local = this_worker_queue();
+                bool const is_plain = info.priority == priority::normal && info.deadline == deadline_clock::time_point::max();
+
+                if (local == nullptr || !is_plain || !push_local(*local, task)) {
+                    std::scoped_lock lock(m_mutex);
+                    m_injected.push(std::move(task), info);
+                    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+                }
+
+                m_queued.fetch_add(1);
+                wake(1);
+            }
+
+            /**
+             * @brief pushes <b>task</b> to the deque of the worker with index <b>index</b>, or to the injection queue
+             * if there is no such worker. Other workers may still steal it
+             */
+            void push_to(std::size_t const index, Task task) {
+                bool pushed = false;
+                {
+                    std::shared_lock lock(m_locals_mutex);
+                    if (index < m_locals.size()) {
+                        local_queue & local = *m_locals[index];
+                        std::scoped_lock local_lock(local.mutex);
+                        local.tasks.push_back(std::move(task));
+                        local.size.store(local.tasks.size(), std::memory_order_relaxed);
+                        pushed = true;
+                    }
+                }
+
+                if (!pushed) {
+                    std::scoped_lock lock(m_mutex);
+                    m_injected.push(std::move(task), {});
+                    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+                }
+
+                m_queued.fetch_add(1);
+                wake(1);
+            }
+
+            /**
+             * @brief pushes all the <b>tasks</b> under one lock to the worker's own deque or to the injection queue
+             * and wakes up to <b>tasks.size()</b> workers
+             */
+            void push_bulk(std::span<Task> tasks) {
+                bool pushed = false;
+                if (local_queue * const local = this_worker_queue()) {
+                    std::scoped_lock lock(local->mutex);
+                    if (!local->removed) {
+                        std::ranges::move(tasks, std::back_inserter(local->tasks));
+                        local->size.store(local->tasks.size(), std::memory_order_relaxed);
+                        pushed = true;
+                    }
+                }
+
+                if (!pushed) {
+                    std::scoped_lock lock(m_mutex);
+                    m_injected.push_bulk(tasks);
+                    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+                }
+
+                m_queued.fetch_add(tasks.size());
+                wake(tasks.size());
+            }
+
+            /**
+             * @brief takes a task from the worker's own deque, then from the injection queue, then from the other workers.
+             * High priority injected tasks are taken first. Blocks if there are no tasks at all
+             * @return false if the worker must exit
+             */
+            template <typename ExitPred>
+            [[nodiscard]] bool pop(Task & task, std::stop_token stop_token, ExitPred should_exit) {
+                while (!should_exit()) {
+                    bool const has_urgent = m_injected.depth(priority::high) > 0;
+                    if ((has_urgent && pop_injected(task)) || pop_local(task) || pop_injected(task) || steal(task)) {
+                        m_queued.fetch_sub(1);
+                        return true;
+                    }
+
+                    std::unique_lock lock(m_mutex);
+                    ++m_sleeping;
+                    bool const has_tasks = m_cv.wait(lock, stop_token, [this] { return m_queued.load() > 0; });
+                    --m_sleeping;
+
+                    if (!has_tasks) {
+                        return false;
+                    }
+                }
+
+                return false;
+            }
+
+            /**
+             * @brief returns the deque of the worker with index <b>index</b>, taken when the worker is created,
+             * as the worker's index changes when workers are swapped
+             */
+            [[nodiscard]] worker_handle worker(std::size_t const index) {
+                std::shared_lock lock(m_locals_mutex);
+                return m_locals[index];
+            }
+
+            /**
+             * @brief binds the calling thread to the worker's deque <b>worker</b>
+             */
+            void attach_worker(worker_handle worker) noexcept {
+                t_worker = {this, std::move(worker)};
+            }
+
+            void add_workers(std::size_t count) {
+                std::scoped_lock lock(m_locals_mutex);
+                for (std::size_t i = 0; i < count; ++i) {
+                    m_locals.push_back(std::make_shared<local_queue>());
+                    m_locals.back()->index = m_locals.size() - 1;
+                }
+            }
+
+            /**
+             * @brief removes the last <b>count</b> deques moving their tasks to the injection queue.
+             * The workers may still be running, their later pushes go to the injection queue
+             */
+            void remove_workers(std::size_t count) {
+                {
+                    std::scoped_lock lock(m_locals_mutex, m_mutex);
+                    for (std::size_t i = 0; i < count && !m_locals.empty(); ++i) {
+                        // the deque may be freed with the pointer if its worker has exited, so it's unlocked first
+                        std::shared_ptr<local_queue> const local = std::move(m_locals.back());
+                        m_locals.pop_back();
+
+                        std::scoped_lock local_lock(local->mutex);
+                        local->removed = true;
+                        m_injected.push_bulk(local->tasks);
+                        local->tasks.clear();
+                        local->size.store(0, std::memory_order_relaxed);
+                    }
+                    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+                }
+                m_cv.notify_all();
+            }
+
+            /**
+             * @brief exchanges the deques of the workers with indices <b>first</b> and <b>second</b> along with the workers themselves
+             */
+            void swap_workers(std::size_t const first, std::size_t const second) {
+                std::scoped_lock lock(m_locals_mutex);
+                std::swap(m_locals[first], m_locals[second]);
+                m_locals[first]->index = first;
+                m_locals[second]->index = second;
+            }
+
+            void notify_all() {
+                m_cv.notify_all();
+            }
+
+            void clear() {
+                std::scoped_lock lock(m_locals_mutex, m_mutex);
+                for (auto & local : m_locals) {
+                    std::scoped_lock local_lock(local->mutex);
+                    m_queued.fetch_sub(local->tasks.size());
+                    local->tasks.clear();
+                    local->size.store(0, std::memory_order_relaxed);
+                }
+                m_queued.fetch_sub(m_injected.size());
+                m_injected.clear();
+                m_injected_size.store(0, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief returns the number of queued tasks of <b>priority</b>, the workers' own tasks are counted as normal
+             */
+            [[nodiscard]] std::size_t depth(priority const priority) {
+                std::size_t depth = m_injected.depth(priority);
+                if (priority == priority::normal) {
+                    std::shared_lock lock(m_locals_mutex);
+                    for (auto const & local : m_locals) {
+                        depth += local->size.load(std::memory_order_relaxed);
+                    }
+                }
+                return depth;
+            }
+
+            void set_lane_options(lane_options const & options) {
+                std::scoped_lock lock(m_mutex);
+                m_injected.set_options(options);
+            }
+
+        private:
+            [[nodiscard]] local_queue * this_worker_queue() const noexcept {
+                return t_worker.owner == this ? t_worker.queue.get() : nullptr;
+            }
+
+            /**
+             * @return false if the deque has been removed, <b>task</b> is left untouched in this case
+             */
+            [[nodiscard]] static bool push_local(local_queue & local, Task & task) {
+                std::scoped_lock lock(local.mutex);
+                if (local.removed) {
+                    return false;
+                }
+
+                local.tasks.push_back(std::move(task));
+                local.size.store(local.tasks.size(), std::memory_order_relaxed);
+                return true;
+            }
+
+            void wake(std::size_t const count) {
+                std::size_t const sleeping = m_sleeping.load();
+                if (sleeping == 0) {
+                    return;
+                }
+
+                {
+                    // a worker can't miss the notification between checking the predicate and waiting
+                    std::scoped_lock lock(m_mutex);
+                }
+                detail::wake(m_cv, count, sleeping);
+            }
+
+            bool pop_local(Task & task) {
+                local_queue * const local = this_worker_queue();
+                if (local == nullptr || local->size.load(std::memory_order_relaxed) == 0) {
+                    return false;
+                }
+
+                std::scoped_lock lock(local->mutex);
+                if (local->tasks.empty()) {
+                    return false;
+                }
+
+                task = std::move(local->tasks.back());
+                local->tasks.pop_back();
+                local->size.store(local->tasks.size(), std::memory_order_relaxed);
+                return true;
+            }
+
+            bool pop_injected(Task & task) {
+                if (m_injected_size.load(std::memory_order_relaxed) == 0) {
+                    return false;
+                }
+
+                std::scoped_lock lock(m_mutex);
+                if (!m_injected.pop(task)) {
+                    return false;
+                }
+
+                m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+                return true;
+            }
+
+            /**
+             * @brief steals from the other workers starting after the worker's current position
+             */
+            bool steal(Task & task) {
+                local_queue * const local = this_worker_queue();
+                std::shared_lock lock(m_locals_mutex);
+                std::size_t const count = m_locals.size();
+                std::size_t const origin = local != nullptr ? local->index : 0;
+
+                for (std::size_t i = 1; i <= count; ++i) {
+                    local_queue & victim = *m_locals[(origin + i) % count];
+                    if (&victim == local || victim.size.load(std::memory_order_relaxed) == 0) {
+                        continue;
+                    }
+
+                    std::scoped_lock victim_lock(victim.mutex);
+                    if (!victim.tasks.empty()) {
+                        task = std::move(victim.tasks.front());
+                        victim.tasks.pop_front();
+                        victim.size.store(victim.tasks.size(), std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+        private:
+            static inline thread_local worker_info t_worker;
+
+            std::mutex m_mutex;
+            std::condition_variable_any m_cv;
+            task_lanes<Task> m_injected;
+            std::atomic<std::size_t> m_injected_size = 0;
+
+            std::atomic<std::size_t> m_queued = 0;
+            std::atomic<std::size_t> m_sleeping = 0;
+
+            std::shared_mutex m_locals_mutex;
+            std::vector<std::shared_ptr<local_queue>> m_locals;
+        };
+
+
+        /**
+         * @brief One bounded lock-free FIFO queue shared by all the workers.
+         * Idle workers park on std::atomic::wait. If the queue is full, a push from outside the pool yields until there is
+         * free space (backpressure), a push from a worker of the pool goes to an unbounded mutex-protected overflow list,
+         * since waiting for the workers to free space from a worker may never end
+         */
+        template <typename Task>
+        class lock_free_task_queue {
+        public:
+            struct worker_handle {};
+
+            static constexpr std::size_t default_capacity = 1 << 16;
+
+            explicit lock_free_task_queue(std::size_t capacity = default_capacity) : m_tasks(capacity) {}
+
+            void push(Task task) {
+                while (!m_tasks.try_push(std::move(task))) {
+                    if (is_worker()) {
+                        push_overflow(std::span(&task, 1));
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+                m_event.notify_one();
+            }
+
+            /**
+             * @brief pushes <b>tasks</b> claiming as many cells as possible with one CAS and wakes up as many workers as tasks pushed.
+             * If the queue is full, waits until workers free some space or, from a worker, overflows
+             */
+            void push_bulk(std::span<Task> tasks) {
+                for (std::size_t pushed = 0; pushed < tasks.size();) {
+                    std::size_t const count = m_tasks.try_push_bulk(tasks.subspan(pushed));
+                    if (count == 0) {
+                        if (is_worker()) {
+                            push_overflow(tasks.subspan(pushed));
+                            return;
+                        }
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    pushed += count;
+                    m_event.notify(count);
+                }
+            }
+
+            /**
+             * @brief blocks until a task is available, the worker is asked to exit or stop is requested and there are no tasks
+             * @return false if the worker must exit
+             */
+            template <typename ExitPred>
+            [[nodiscard]] bool pop(Task & task, std::stop_token stop_token, ExitPred should_exit) {
+                while (!should_exit()) {
+                    if (try_pop(task)) {
+                        return true;
+                    }
+
+                    auto const key = m_event.prepare_wait();
+                    if (try_pop(task)) {
+                        m_event.cancel_wait();
+                        return true;
+                    }
+                    if (stop_token.stop_requested()) {
+                        m_event.cancel_wait();
+                        return false;
+                    }
+
+                    std::stop_callback const wake_on_stop(stop_token, [this] { m_event.notify_all(); });
+                    m_event.wait(key);
+                }
+
+                return false;
+            }
+
+            /**
+             * @brief marks the calling thread as a worker of the queue, so it overflows instead of waiting for free space
+             */
+            [[nodiscard]] worker_handle worker(std::size_t) const noexcept {
+                return {};
+            }
+
+            void attach_worker(worker_handle) noexcept {
+                t_owner = this;
+            }
+
+            void add_workers(std::size_t) {}
+
+            void remove_workers(std::size_t) {}
+
+            void swap_workers(std::size_t, std::size_t) noexcept {}
+
+            void notify_all() {
+                m_event.notify_all();
+            }
+
+            void clear() {
+                Task task;
+                while (m_tasks.try_pop(task)) {}
+
+                std::scoped_lock lock(m_overflow_mutex);
+                m_overflow.clear();
+                m_overflow_size.store(0, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief the queue has no lanes, all its tasks are counted as normal
+             */
+            [[nodiscard]] std::size_t depth(priority const priority) const noexcept {
+                return priority == priority::normal ? m_tasks.size() + m_overflow_size.load(std::memory_order_relaxed) : 0;
+            }
+
+        private:
+            [[nodiscard]] bool is_worker() const noexcept {
+                return t_owner == this;
+            }
+
+            void push_overflow(std::span<Task> tasks) {
+                {
+                    std::scoped_lock lock(m_overflow_mutex);
+                    std::ranges::move(tasks, std::back_inserter(m_overflow));
+                    m_overflow_size.store(m_overflow.size(), std::memory_order_relaxed);
+                }
+                m_event.notify(tasks.size());
+            }
+
+            /**
+             * @brief takes the overflowed tasks first, they were pushed when the queue was full, so they are older than most
+             * of the queued ones
+             */
+            [[nodiscard]] bool try_pop(Task & task) {
+                if (m_overflow_size.load(std::memory_order_relaxed) > 0) {
+                    std::scoped_lock lock(m_overflow_mutex);
+                    if (!m_overflow.empty()) {
+                        task = std::move(m_overflow.front());
+                        m_overflow.pop_front();
+                        m_overflow_size.store(m_overflow.size(), std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+                return m_tasks.try_pop(task);
+            }
+
+        private:
+            static inline thread_local lock_free_task_queue const * t_owner = nullptr;
+
+            mpmc_queue<Task> m_tasks;
+            event_count m_event;
+
+            std::mutex m_overflow_mutex;
+            std::deque<Task> m_overflow;
+            std::atomic<std::size_t> m_overflow_size = 0;
+        };
+
+
+        template <scheduling Sched, typename Task>
+        struct task_queue;
+
+        template <typename Task>
+        struct task_queue<scheduling::shared_queue, Task> : std::type_identity<shared_task_queue<Task>> {};
+
+        template <typename Task>
+        struct task_queue<scheduling::work_stealing, Task> : std::type_identity<work_stealing_task_queue<Task>> {};
+
+        template <typename Task>
+        struct task_queue<scheduling::lock_free, Task> : std::type_identity<lock_free_task_queue<Task>> {};
+
+        template <scheduling Sched, typename Task>
+        using task_queue_t = typename task_queue<Sched, Task>::type;
+
+    }
+
+}
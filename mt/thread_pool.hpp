@@ -1,61 +1,388 @@
 #pragma once
 
 #include <thread>
-#include <future>
-#include <condition_variable>
 #include <vector>
-#include <queue>
-#include <set>
+#include <span>
+#include <ranges>
+#include <algorithm>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <optional>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
 
 #include <eon/concepts.hpp>
 #include <eon/mt/concurrency_info.hpp>
+#include <eon/mt/task_queue.hpp>
+#include <eon/mt/small_task.hpp>
+#include <eon/mt/histogram.hpp>
+#include <eon/mt/mutex.hpp>
+#include <eon/mt/strand.hpp>
+#include <eon/mt/slab_allocator.hpp>
+#include <eon/mt/future.hpp>
+#include <eon/mt/topology.hpp>
+#include <eon/mt/affinity.hpp>
 
 
 namespace eon::mt {
 
-    template <typename R = void>
+    /**
+     * @brief Bounds and thresholds of an elastic <b>eon::mt::thread_pool</b>.
+     * The pool grows when more than <b>grow_queue_depth</b> tasks per worker are waiting or a task has waited
+     * longer than <b>grow_wait</b>, and retires workers which have been idle for <b>keep_alive</b>
+     */
+    struct elastic_options {
+        unsigned min_threads = 1;
+        unsigned max_threads = concurrent_available();
+        std::size_t grow_queue_depth = 4;
+        std::chrono::microseconds grow_wait = std::chrono::milliseconds(2);
+        std::chrono::microseconds keep_alive = std::chrono::seconds(10);
+    };
+
+    struct worker_metrics {
+        std::uint64_t completed = 0;
+        std::chrono::nanoseconds busy{0};   ///< time spent running tasks, including the current one
+        std::chrono::nanoseconds idle{0};   ///< time spent waiting for tasks, including the current wait
+    };
+
+    /**
+     * @brief Snapshot of the counters of <b>eon::mt::thread_pool</b>. The counters of retired workers
+     * are included in the totals and the histograms but not in <b>workers</b>
+     */
+    struct pool_metrics {
+        std::size_t threads = 0;
+        std::size_t queue_depth = 0;        ///< tasks waiting in all the lanes
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0;
+        std::vector<worker_metrics> workers;
+        duration_histogram wait_histogram{};    ///< time from adding a task to starting it
+        std::chrono::nanoseconds wait_total{0};
+        std::chrono::nanoseconds wait_max{0};
+        duration_histogram exec_histogram{};    ///< time of running a task
+        std::chrono::nanoseconds exec_total{0};
+        std::chrono::nanoseconds exec_max{0};
+
+        /**
+         * @brief returns the upper bound of the bucket containing the <b>quantile</b> (0..1) of <b>histogram</b>
+         */
+        [[nodiscard]] static std::chrono::nanoseconds quantile(duration_histogram const & histogram, double const quantile) noexcept {
+            return histogram_quantile(histogram, quantile);
+        }
+    };
+
+    namespace detail {
+
+        using pool_clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Task of a pool queue with the time it was added at
+         */
+        struct queued_task {
+            small_task task;
+            pool_clock::rep added = 0;
+        };
+
+        enum class worker_activity : std::uint8_t {
+            idle,
+            busy,
+            stopping    ///< the worker exits without starting another task
+        };
+
+        /**
+         * @brief State and counters of one pool worker. Everything but <b>activity</b> is written by the worker only
+         * with relaxed loads and stores, readers aggregate the counters
+         */
+        struct alignas(cache_line_size) worker_state {
+            using clock = pool_clock;
+
+            static constexpr clock::rep busy = std::numeric_limits<clock::rep>::max();
+
+            std::atomic<worker_activity> activity = worker_activity::idle;
+            std::atomic<std::uint64_t> taken = 0;
+            std::atomic<std::uint64_t> completed = 0;
+            std::atomic<clock::rep> idle_since = clock::now().time_since_epoch().count();
+            std::atomic<clock::rep> busy_since = 0;
+            std::atomic<std::uint64_t> busy_time = 0;
+            std::atomic<std::uint64_t> idle_time = 0;
+            relaxed_histogram wait;
+            relaxed_histogram exec;
+
+            void begin_task(clock::rep const now, clock::rep const added) noexcept {
+                increase(taken, 1);
+                increase(idle_time, nanoseconds(now - idle_since.load(std::memory_order_relaxed)));
+                wait.add(nanoseconds(now - added));
+                busy_since.store(now, std::memory_order_relaxed);
+                idle_since.store(busy, std::memory_order_relaxed);
+            }
+
+            void end_task(clock::rep const start, clock::rep const now) noexcept {
+                std::uint64_t const exec_time = nanoseconds(now - start);
+                exec.add(exec_time);
+                increase(busy_time, exec_time);
+                increase(completed, 1);
+                idle_since.store(now, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief called by the worker with a task taken from the queue
+             * @return false if the worker is stopping and must leave the task to the others
+             */
+            [[nodiscard]] bool try_start() noexcept {
+                auto expected = worker_activity::idle;
+                return activity.compare_exchange_strong(expected, worker_activity::busy, std::memory_order_acq_rel);
+            }
+
+            /**
+             * @brief called by the worker after a task, keeps the stopping state
+             */
+            void finish() noexcept {
+                auto expected = worker_activity::busy;
+                activity.compare_exchange_strong(expected, worker_activity::idle, std::memory_order_acq_rel);
+            }
+
+            /**
+             * @brief makes the worker exit after its current task
+             */
+            void stop() noexcept {
+                activity.store(worker_activity::stopping, std::memory_order_release);
+            }
+
+            /**
+             * @brief makes the worker exit if it's idle, so it's known not to run a task
+             * @return false if the worker is running a task
+             */
+            [[nodiscard]] bool try_retire() noexcept {
+                auto expected = worker_activity::idle;
+                return activity.compare_exchange_strong(expected, worker_activity::stopping, std::memory_order_acq_rel);
+            }
+
+            [[nodiscard]] bool stopping() const noexcept {
+                return activity.load(std::memory_order_acquire) == worker_activity::stopping;
+            }
+
+            [[nodiscard]] bool idle_for(clock::time_point const now, clock::duration const duration) const noexcept {
+                clock::rep const since = idle_since.load(std::memory_order_relaxed);
+                return since != busy && now - clock::time_point(clock::duration(since)) >= duration;
+            }
+
+            /**
+             * @brief adds the histograms and the number of completed tasks to <b>metrics</b>
+             * @return the worker's own counters as of <b>now</b>
+             */
+            worker_metrics add_to(pool_metrics & metrics, clock::time_point const now) const noexcept {
+                wait.add_to(metrics.wait_histogram, metrics.wait_total, metrics.wait_max);
+                exec.add_to(metrics.exec_histogram, metrics.exec_total, metrics.exec_max);
+
+                worker_metrics worker{
+                    completed.load(std::memory_order_relaxed),
+                    std::chrono::nanoseconds(busy_time.load(std::memory_order_relaxed)),
+                    std::chrono::nanoseconds(idle_time.load(std::memory_order_relaxed))
+                };
+                metrics.completed += worker.completed;
+
+                clock::rep const current = now.time_since_epoch().count();
+                clock::rep const since = idle_since.load(std::memory_order_relaxed);
+                if (since == busy) {
+                    worker.busy += std::chrono::nanoseconds(nanoseconds(current - busy_since.load(std::memory_order_relaxed)));
+                }
+                else {
+                    worker.idle += std::chrono::nanoseconds(nanoseconds(current - since));
+                }
+                return worker;
+            }
+
+            [[nodiscard]] static std::uint64_t nanoseconds(clock::rep const ticks) noexcept {
+                auto const duration = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::duration(ticks));
+                return static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0));
+            }
+        };
+
+    }
+
+    template <typename R = void, scheduling Sched = scheduling::shared_queue>
     class thread_pool {
-        using task_t = std::packaged_task<R()>;
+        using task_t = small_task;
+        using queue_t = detail::task_queue_t<Sched, detail::queued_task>;
+        using clock = detail::pool_clock;
 
     public:
         explicit thread_pool(unsigned threads_count = concurrent_available()) {
             add_threads(threads_count);
         }
 
+        /**
+         * @brief creates a pool whose lock-free task queue holds at most <b>queue_capacity</b> tasks (rounded up to a power of two).
+         * add_task blocks while the queue is full
+         */
+        thread_pool(unsigned threads_count, std::size_t queue_capacity) requires (Sched == scheduling::lock_free) : m_queue(queue_capacity) {
+            add_threads(threads_count);
+        }
+
+        /**
+         * @brief creates a pool whose workers are pinned to CPUs according to <b>placement</b>.
+         * With scheduling::work_stealing tasks with <b>task_info::node</b> go to the workers of that node
+         */
+        thread_pool(unsigned threads_count, placement placement) : m_placement_slots(detail::placement_slots(topology::system(), placement)) {
+            add_threads(threads_count);
+        }
+
+        /**
+         * @brief creates an elastic pool with <b>options.min_threads</b> workers. A supervisor thread adds workers
+         * up to <b>options.max_threads</b> while tasks pile up and retires the workers idle for <b>options.keep_alive</b>.
+         * Only idle workers are retired, they are joined without holding the pool's resize lock
+         */
+        explicit thread_pool(elastic_options const & options) : m_elastic(options) {
+            if (options.min_threads > options.max_threads || options.max_threads == 0) {
+                throw std::invalid_argument("eon::mt::thread_pool: invalid elastic bounds");
+            }
+
+            add_threads(options.min_threads);
+            m_supervisor = std::jthread(std::bind_front(&thread_pool::supervise, this));
+        }
+
         template <typename Fn>
         requires (std::is_invocable_r_v<R, std::decay_t<Fn>>)
-        [[nodiscard]] std::future<R> add_task(Fn && fn) {
-            task_t task(std::forward<Fn>(fn));
-            auto future = task.get_future();
-            {
-                std::scoped_lock lock(m_queue_mutex);
-                m_tasks.push_back(std::move(task));
+        [[nodiscard]] future<R> add_task(Fn && fn) {
+            return push_with_future<R>(std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief adds a task to the lane of <b>info.priority</b>. Tasks with a deadline are taken earliest deadline first
+         * before the other tasks of their lane, e.g. <b>add_task({priority::high, deadline_clock::now() + 5ms}, fn)</b>
+         */
+        template <typename Fn>
+        requires (Sched != scheduling::lock_free && std::is_invocable_r_v<R, std::decay_t<Fn>>)
+        [[nodiscard]] future<R> add_task(task_info const & info, Fn && fn) {
+            return push_with_future<R>(std::forward<Fn>(fn), info);
+        }
+
+        /**
+         * @brief adds a task which runs after all the tasks previously added with the same <b>key</b> and never concurrently with them,
+         * e.g. <b>add_task(affinity_key{session_id}, fn)</b>. Tasks of one key are queued without locks and usually run
+         * on the same worker
+         */
+        template <typename Fn>
+        requires (std::is_invocable_r_v<R, std::decay_t<Fn>>)
+        [[nodiscard]] future<R> add_task(affinity_key const key, Fn && fn) {
+            return push_with_future<R>(std::forward<Fn>(fn), key);
+        }
+
+        /**
+         * @brief adds a task and returns the future for its own result type, so one pool can run tasks with different results
+         */
+        template <typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &>)
+        [[nodiscard]] future<std::invoke_result_t<std::decay_t<Fn> &>> submit(Fn && fn) {
+            return push_with_future<std::invoke_result_t<std::decay_t<Fn> &>>(std::forward<Fn>(fn));
+        }
+
+        template <typename Fn>
+        requires (Sched != scheduling::lock_free && std::invocable<std::decay_t<Fn> &>)
+        [[nodiscard]] future<std::invoke_result_t<std::decay_t<Fn> &>> submit(task_info const & info, Fn && fn) {
+            return push_with_future<std::invoke_result_t<std::decay_t<Fn> &>>(std::forward<Fn>(fn), info);
+        }
+
+        template <typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &>)
+        [[nodiscard]] future<std::invoke_result_t<std::decay_t<Fn> &>> submit(affinity_key const key, Fn && fn) {
+            return push_with_future<std::invoke_result_t<std::decay_t<Fn> &>>(std::forward<Fn>(fn), key);
+        }
+
+        /**
+         * @brief adds a task whose result is not needed. Exceptions escaping <b>fn</b> call std::terminate
+         */
+        template <typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &>)
+        void post(Fn && fn) {
+            push(task_t(std::forward<Fn>(fn)));
+        }
+
+        template <typename Fn>
+        requires (Sched != scheduling::lock_free && std::invocable<std::decay_t<Fn> &>)
+        void post(task_info const & info, Fn && fn) {
+            push(task_t(std::forward<Fn>(fn)), info);
+        }
+
+        template <typename Fn>
+        requires (std::invocable<std::decay_t<Fn> &>)
+        void post(affinity_key const key, Fn && fn) {
+            push(task_t(std::forward<Fn>(fn)), key);
+        }
+
+        /**
+         * @brief adds all the callables from <b>rng</b> as tasks whose results are not needed.
+         * They are enqueued with one lock acquisition (one CAS for the lock-free queue) and wake only as many workers as needed.
+         * The callables are moved from if <b>rng</b> is an rvalue or they can't be copied (e.g. <b>small_task</b>).
+         * Exceptions escaping the callables call std::terminate
+         */
+        template <std::ranges::input_range Rng>
+        requires (std::invocable<std::decay_t<std::ranges::range_reference_t<Rng>> &>)
+        void post_bulk(Rng && rng) {
+            std::vector<detail::queued_task> tasks;
+            if constexpr (std::ranges::sized_range<Rng>) {
+                tasks.reserve(std::ranges::size(rng));
             }
-            m_cv.notify_one();
 
-            return future;
+            clock::rep const added = clock::now().time_since_epoch().count();
+            for (auto it = std::ranges::begin(rng); it != std::ranges::end(rng); ++it) {
+                tasks.push_back({bulk_task<Rng>(it), added});
+            }
+
+            if (!tasks.empty()) {
+                count_submitted(tasks.size());
+                m_queue.push_bulk(tasks);
+            }
+        }
+
+        /**
+         * @brief adds all the callables from <b>rng</b> in order as tasks of <b>key</b>, with one wake-up at most.
+         * The callables are moved from like in the unkeyed overload. Exceptions escaping the callables call std::terminate
+         */
+        template <std::ranges::input_range Rng>
+        requires (std::invocable<std::decay_t<std::ranges::range_reference_t<Rng>> &>)
+        void post_bulk(affinity_key const key, Rng && rng) {
+            std::vector<task_t> tasks;
+            if constexpr (std::ranges::sized_range<Rng>) {
+                tasks.reserve(std::ranges::size(rng));
+            }
+
+            for (auto it = std::ranges::begin(rng); it != std::ranges::end(rng); ++it) {
+                tasks.push_back(bulk_task<Rng>(it));
+            }
+
+            std::size_t const slot = detail::strand_table::slot(key);
+            if (m_strands.push_bulk(slot, tasks)) {
+                schedule_strand(slot);
+            }
         }
 
+        /**
+         * @brief sets the number of workers. The removed workers finish the queued tasks before exiting.
+         * An elastic pool keeps adjusting its size within its bounds afterwards
+         */
         void resize(unsigned threads_count) {
+            std::scoped_lock lock(m_resize_mutex);
             if (threads_count <= m_threads.size()) {
-                m_threads.resize(threads_count);
+                remove_threads(threads_count);
             }
             else {
                 add_threads(threads_count - m_threads.size());
             }
         }
 
+        /**
+         * @brief sets the number of workers. The removed workers exit after their current task
+         */
         void force_resize(unsigned threads_count) {
+            std::scoped_lock lock(m_resize_mutex);
             if (threads_count < m_threads.size()) {
-                std::size_t const threads_count_to_stop = m_threads.size() - threads_count;
-                auto ids_to_stop = std::span(m_threads).last(threads_count_to_stop) | std::views::transform(&std::jthread::get_id);
-                {
-                    std::scoped_lock lock(m_force_stop_mutex);
-                    m_threads_to_force_stop.insert_range(ids_to_stop);
-                }
-                m_threads.resize(threads_count);
-                m_cv.notify_all();
+                force_remove_threads(threads_count);
             }
             else {
                 add_threads(threads_count - m_threads.size());
@@ -63,73 +390,440 @@ namespace eon::mt {
         }
 
         void request_stop() {
+            m_supervisor.request_stop();
+            std::scoped_lock lock(m_resize_mutex);
             std::ranges::for_each(m_threads, &std::jthread::request_stop);
         }
 
         void wait() {
-            request_stop();
-            std::ranges::for_each(m_threads, &std::jthread::join);
+            stop_supervisor();
+            std::scoped_lock lock(m_resize_mutex);
+            std::ranges::for_each(m_threads, &std::jthread::request_stop);
+            std::ranges::for_each(m_threads, [](std::jthread & thread) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            });
         }
 
         void wait_and_deallocate() {
-            m_threads.clear();
+            stop_supervisor();
+            std::scoped_lock lock(m_resize_mutex);
+            remove_threads(0);
             m_threads.shrink_to_fit();
-            m_threads_to_force_stop.clear();
-            m_tasks.clear();
-            m_tasks.shrink_to_fit();
+            m_workers.shrink_to_fit();
+            m_queue.clear();
+            m_strands.clear();
         }
 
         [[nodiscard]] std::size_t size() const noexcept {
-            return m_threads.size();
+            return m_size.load(std::memory_order_relaxed);
         }
 
-    private:
-        void add_threads(unsigned threads_count) {
-            m_threads.reserve(m_threads.size() + threads_count);
-            for (unsigned i = 0; i < threads_count; ++i) {
-                m_threads.emplace_back(std::bind_front(&thread_pool::work, this));
+        /**
+         * @brief returns the number of tasks waiting in the lane of <b>priority</b>
+         */
+        [[nodiscard]] std::size_t queue_depth(priority const priority = priority::normal) {
+            return m_queue.depth(priority);
+        }
+
+        /**
+         * @brief returns the current counters of the pool. The workers keep them with relaxed stores to their own cache lines,
+         * the snapshot sums them up, so the values of different workers may be a few tasks apart
+         */
+        [[nodiscard]] pool_metrics metrics() {
+            std::scoped_lock lock(m_resize_mutex);
+            clock::time_point const now = clock::now();
+
+            pool_metrics metrics = m_retired_metrics;
+            metrics.threads = m_threads.size();
+            metrics.queue_depth = total_depth();
+            for (std::size_t i = 0; i < m_submitted_shards; ++i) {
+                metrics.submitted += m_submitted[i].value.load(std::memory_order_relaxed);
+            }
+
+            metrics.workers.reserve(m_workers.size());
+            for (auto const & worker : m_workers) {
+                metrics.workers.push_back(worker->add_to(metrics, now));
             }
+            return metrics;
         }
 
-        void work(std::stop_token stop_token) {
-            task_t task;
-            std::set<std::jthread::id>::iterator it;
+        /**
+         * @brief sets how workers choose the lane to take the next task from
+         */
+        void set_lane_options(lane_options const & options) requires (Sched != scheduling::lock_free) {
+            m_queue.set_lane_options(options);
+        }
 
-            while (true) {
-                std::unique_lock lock(m_queue_mutex);
-                bool const has_tasks = m_cv.wait(lock, stop_token, [this] { return !m_tasks.empty(); });
+    private:
+        template <typename T, typename Fn, typename... Info>
+        [[nodiscard]] future<T> push_with_future(Fn && fn, Info const &... info) {
+            promise<T> promise(*m_allocator);
+            auto future = promise.get_future();
+            push([promise = std::move(promise), fn = std::forward<Fn>(fn)]() mutable {
+                detail::invoke_into(promise, fn);
+            }, info...);
 
-                {
-                    std::scoped_lock force_stop_lock(m_force_stop_mutex);
-                    it = m_threads_to_force_stop.find(std::this_thread::get_id());
-                    if (it != m_threads_to_force_stop.end()) {
-                        break;
+            return future;
+        }
+
+        /**
+         * @brief makes a task of the element at <b>it</b> of a range passed to post_bulk, moving from it if the range is
+         * an rvalue which doesn't borrow its elements or the element can't be copied
+         */
+        template <typename Rng, typename It>
+        [[nodiscard]] static task_t bulk_task(It const & it) {
+            using element_t = std::remove_cvref_t<std::ranges::range_reference_t<Rng>>;
+            if constexpr ((std::is_rvalue_reference_v<Rng &&> && !std::ranges::borrowed_range<Rng>) || !std::copy_constructible<element_t>) {
+                return task_t(std::ranges::iter_move(it));
+            }
+            else {
+                return task_t(*it);
+            }
+        }
+
+        void push(task_t task) {
+            count_submitted(1);
+            m_queue.push(queued(std::move(task)));
+        }
+
+        void push(task_t task, task_info const & info) {
+            count_submitted(1);
+            if constexpr (Sched == scheduling::work_stealing) {
+                bool const is_plain = info.priority == priority::normal && info.deadline == deadline_clock::time_point::max();
+                if (info.node != any_node && is_plain) {
+                    if (std::optional<std::size_t> const worker = worker_on_node(info.node)) {
+                        m_queue.push_to(*worker, queued(std::move(task)));
+                        return;
                     }
                 }
+            }
 
-                if (!has_tasks) {
+            m_queue.push(queued(std::move(task)), info);
+        }
+
+        void push(task_t task, affinity_key const key) {
+            std::size_t const slot = detail::strand_table::slot(key);
+            if (m_strands.push(slot, std::move(task))) {
+                schedule_strand(slot);
+            }
+        }
+
+        /**
+         * @brief queues the drain of the strand <b>slot</b>. With scheduling::work_stealing it goes to the deque
+         * of the strand's worker, so a key stays on one worker while the pool size doesn't change
+         */
+        void schedule_strand(std::size_t const slot) {
+            task_t drain = [this, slot] {
+                if (m_strands.drain(slot)) {
+                    schedule_strand(slot);
+                }
+            };
+
+            if constexpr (Sched == scheduling::work_stealing) {
+                if (std::size_t const size = this->size(); size > 0) {
+                    count_submitted(1);
+                    m_queue.push_to(slot % size, queued(std::move(drain)));
                     return;
                 }
+            }
+
+            push(std::move(drain));
+        }
+
+        [[nodiscard]] static detail::queued_task queued(task_t task) {
+            return {std::move(task), clock::now().time_since_epoch().count()};
+        }
+
+        /**
+         * @brief counts submitted tasks in the shard of the calling thread, so submitters on different CPUs don't contend
+         */
+        void count_submitted(std::size_t const count) noexcept {
+            m_submitted[detail::thread_shard() % m_submitted_shards].value.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief returns the next worker on <b>node</b> in round-robin order
+         */
+        [[nodiscard]] std::optional<std::size_t> worker_on_node(std::size_t const node) {
+            std::shared_lock lock(m_nodes_mutex);
+            std::size_t const count = m_worker_nodes.size();
+            std::size_t const start = m_node_cursor.fetch_add(1, std::memory_order_relaxed);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t const index = (start + i) % count;
+                if (m_worker_nodes[index] == node) {
+                    return index;
+                }
+            }
+            return std::nullopt;
+        }
+
+        void add_threads(std::size_t threads_count) {
+            std::size_t const first_index = m_threads.size();
+            m_queue.add_workers(threads_count);
+            m_threads.reserve(first_index + threads_count);
+            m_workers.reserve(first_index + threads_count);
+            for (std::size_t i = first_index; i < first_index + threads_count; ++i) {
+                m_workers.push_back(std::make_unique<detail::worker_state>());
+                m_threads.emplace_back(std::bind_front(&thread_pool::work, this), m_queue.worker(i), m_workers.back().get());
+                place_thread(i);
+            }
+            m_size.store(m_threads.size(), std::memory_order_relaxed);
+        }
+
+        void remove_threads(std::size_t threads_count) {
+            std::size_t const threads_count_to_remove = m_threads.size() - threads_count;
+            m_threads.resize(threads_count);
+            clock::time_point const now = clock::now();
+            for (auto const & worker : std::span(m_workers).subspan(threads_count)) {
+                worker->add_to(m_retired_metrics, now);
+            }
+            m_workers.resize(threads_count);
+            m_size.store(threads_count, std::memory_order_relaxed);
+            m_queue.remove_workers(threads_count_to_remove);
+
+            std::scoped_lock lock(m_nodes_mutex);
+            if (m_worker_nodes.size() > threads_count) {
+                m_worker_nodes.resize(threads_count);
+            }
+        }
+
+        /**
+         * @brief pins the worker with <b>index</b> to its placement slot and remembers its node
+         */
+        void place_thread(std::size_t const index) {
+            if (m_placement_slots.empty()) {
+                return;
+            }
+
+            auto const & cpus = m_placement_slots[index % m_placement_slots.size()];
+            detail::set_affinity(m_threads[index].native_handle(), cpus);
+
+            std::scoped_lock lock(m_nodes_mutex);
+            m_worker_nodes.push_back(detail::cpus_node(topology::system(), cpus));
+        }
+
+        /**
+         * @brief asks the workers starting from <b>threads_count</b> to exit after their current task and removes them
+         */
+        void force_remove_threads(std::size_t threads_count) {
+            for (auto const & worker : std::span(m_workers).subspan(threads_count)) {
+                worker->stop();
+            }
+            m_queue.notify_all();
+            remove_threads(threads_count);
+        }
+
+        /**
+         * @brief Workers taken out of the pool, joined when destroyed, which is done without holding the resize lock
+         */
+        struct retired_workers {
+            std::vector<std::unique_ptr<detail::worker_state>> states;
+            std::vector<std::jthread> threads;  // destroyed first, so the workers exit before their states are freed
+        };
+
+        /**
+         * @brief stops up to <b>max_count</b> workers idle for the keep-alive time, moves them to the end and removes them.
+         * The stopped workers can't start a task, so the queue can drop their deques before they exit
+         */
+        [[nodiscard]] retired_workers retire_idle_threads(clock::time_point const now, std::size_t const max_count) {
+            std::size_t const size = m_threads.size();
+            std::vector<bool> retired(size);
+            std::size_t count = 0;
+            for (std::size_t i = size; i-- > 0 && count < max_count;) {
+                if (m_workers[i]->idle_for(now, m_elastic->keep_alive) && m_workers[i]->try_retire()) {
+                    retired[i] = true;
+                    ++count;
+                }
+            }
+            if (count == 0) {
+                return {};
+            }
 
-                task = std::move(m_tasks.front());
-                m_tasks.pop_front();
-                lock.unlock();
+            for (std::size_t first = 0, last = size;;) {
+                while (first < size && !retired[first]) {
+                    ++first;
+                }
+                while (last > 0 && retired[last - 1]) {
+                    --last;
+                }
+                if (first >= last) {
+                    break;
+                }
 
-                task();
+                swap_threads(first, last - 1);
+                retired[first] = false;
+                retired[last - 1] = true;
             }
 
-            std::scoped_lock lock(m_force_stop_mutex);
-            m_threads_to_force_stop.erase(it);
+            std::size_t const threads_count = size - count;
+            retired_workers result;
+            for (auto const & worker : std::span(m_workers).subspan(threads_count)) {
+                worker->add_to(m_retired_metrics, now);
+            }
+            std::ranges::move(std::span(m_workers).subspan(threads_count), std::back_inserter(result.states));
+            std::ranges::move(std::span(m_threads).subspan(threads_count), std::back_inserter(result.threads));
+            m_workers.resize(threads_count);
+            m_threads.resize(threads_count);
+            m_size.store(threads_count, std::memory_order_relaxed);
+            m_queue.remove_workers(count);
+
+            std::scoped_lock lock(m_nodes_mutex);
+            if (m_worker_nodes.size() > threads_count) {
+                m_worker_nodes.resize(threads_count);
+            }
+            return result;
+        }
+
+        /**
+         * @brief exchanges the positions of two workers, so a worker's index in the pool no longer matches the one it started with
+         */
+        void swap_threads(std::size_t const first, std::size_t const second) {
+            std::swap(m_threads[first], m_threads[second]);
+            std::swap(m_workers[first], m_workers[second]);
+            m_queue.swap_workers(first, second);
+
+            std::scoped_lock lock(m_nodes_mutex);
+            if (second < m_worker_nodes.size()) {
+                std::swap(m_worker_nodes[first], m_worker_nodes[second]);
+            }
+        }
+
+        /**
+         * @brief worker loop. <b>worker</b> is the worker's handle in the queue taken when it was created,
+         * the worker doesn't keep its index as retiring workers moves them around the pool
+         */
+        void work(std::stop_token stop_token, typename queue_t::worker_handle worker, detail::worker_state * state) {
+            m_queue.attach_worker(std::move(worker));
+
+            auto const should_exit = [state] { return state->stopping(); };
+            detail::queued_task task;
+            while (m_queue.pop(task, stop_token, should_exit)) {
+                if (!state->try_start()) {
+                    // retired between taking the task and starting it
+                    m_queue.push(std::move(task));
+                    break;
+                }
+
+                clock::rep const start = clock::now().time_since_epoch().count();
+                state->begin_task(start, task.added);
+                task.task();
+                state->end_task(start, clock::now().time_since_epoch().count());
+                state->finish();
+            }
+        }
+
+        void stop_supervisor() {
+            if (m_supervisor.joinable()) {
+                m_supervisor.request_stop();
+                m_supervisor.join();
+            }
+        }
+
+        /**
+         * @brief The oldest task seen waiting by the supervisor: it's taken once the workers have taken <b>target</b> tasks in total
+         */
+        struct backlog_mark {
+            clock::time_point since;
+            std::size_t target;
+        };
+
+        void supervise(std::stop_token stop_token) {
+            auto const interval = std::max<clock::duration>(std::min(m_elastic->grow_wait, m_elastic->keep_alive) / 2, std::chrono::microseconds(100));
+
+            std::mutex mutex;
+            std::condition_variable_any cv;
+            std::optional<backlog_mark> mark;
+
+            std::unique_lock lock(mutex);
+            while (!cv.wait_for(lock, stop_token, interval, [] { return false; }) && !stop_token.stop_requested()) {
+                retired_workers const retired = adjust(mark);
+            }
+        }
+
+        /**
+         * @brief grows the pool if tasks pile up or wait too long, otherwise retires the workers idle for the keep-alive time
+         * @return the retired workers to join after the resize lock is released
+         */
+        [[nodiscard]] retired_workers adjust(std::optional<backlog_mark> & mark) {
+            std::scoped_lock lock(m_resize_mutex);
+            clock::time_point const now = clock::now();
+            std::size_t const size = m_threads.size();
+            std::size_t const depth = total_depth();
+            std::size_t const taken = total_taken();
+
+            if (depth == 0) {
+                mark.reset();
+            }
+            else if (!mark || taken >= mark->target) {
+                mark = backlog_mark{now, taken + depth};
+            }
+
+            std::size_t const grow_depth = std::max<std::size_t>(m_elastic->grow_queue_depth, 1);
+            bool const backlogged = depth > grow_depth * size || (mark && now - mark->since >= m_elastic->grow_wait);
+            if (backlogged) {
+                if (size < m_elastic->max_threads) {
+                    std::size_t const wanted = (depth + grow_depth - 1) / grow_depth;
+                    add_threads(std::clamp<std::size_t>(wanted > size ? wanted - size : 1, 1, m_elastic->max_threads - size));
+                    mark.reset();
+                }
+                return {};
+            }
+
+            if (size > m_elastic->min_threads) {
+                return retire_idle_threads(now, size - m_elastic->min_threads);
+            }
+            return {};
+        }
+
+        [[nodiscard]] std::size_t total_depth() {
+            std::size_t depth = 0;
+            for (std::size_t i = 0; i < priorities_count; ++i) {
+                depth += m_queue.depth(static_cast<priority>(i));
+            }
+            return depth;
+        }
+
+        [[nodiscard]] std::size_t total_taken() const noexcept {
+            std::size_t taken = m_retired_metrics.completed;
+            for (auto const & worker : m_workers) {
+                taken += worker->taken.load(std::memory_order_relaxed);
+            }
+            return taken;
         }
 
     private:
-        std::mutex m_queue_mutex;
-        std::mutex m_force_stop_mutex;
-        std::condition_variable_any m_cv;
+        detail::slab_allocator::handle m_allocator = detail::slab_allocator::make();
+        detail::strand_table m_strands{*m_allocator};
+        queue_t m_queue;
+
+        std::vector<topology::cpu_group> const m_placement_slots;
+        std::shared_mutex m_nodes_mutex;
+        std::vector<std::size_t> m_worker_nodes;
+        std::atomic<std::size_t> m_node_cursor = 0;
+
+        std::optional<elastic_options> const m_elastic;
+        std::mutex m_resize_mutex;
+        std::vector<std::unique_ptr<detail::worker_state>> m_workers;
+        pool_metrics m_retired_metrics;
+        std::atomic<std::size_t> m_size = 0;
+
+        std::size_t const m_submitted_shards = available();
+        std::unique_ptr<detail::padded<std::atomic<std::uint64_t>>[]> const m_submitted = std::make_unique<detail::padded<std::atomic<std::uint64_t>>[]>(m_submitted_shards);
 
-        std::deque<task_t> m_tasks;
-        std::set<std::jthread::id> m_threads_to_force_stop;
         std::vector<std::jthread> m_threads;
+        std::jthread m_supervisor;
     };
 
+    /**
+     * @brief Returns the process-wide pool, created on the first call.
+     * It has one thread less than eon::mt::concurrent_available() as the fork-join algorithms run a part of the work on the calling thread
+     */
+    [[nodiscard]] inline thread_pool<> & default_pool() {
+        static thread_pool<> pool(concurrent_available() - 1);
+        return pool;
+    }
+
 }
\ No newline at end of file
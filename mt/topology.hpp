@@ -0,0 +1,259 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <span>
+#include <exception>
+#include <system_error>
+#include <cctype>
+#include <cstddef>
+
+namespace eon::mt {
+
+    /**
+     * @brief Hardware thread context (logical CPU) and the indices of the groups it belongs to
+     */
+    struct logical_cpu {
+        unsigned id;        ///< number of the CPU in the operating system
+        std::size_t core;   ///< index in topology::cores()
+        std::size_t package;///< index in topology::packages()
+        std::size_t node;   ///< index in topology::nodes()
+        std::size_t l2;     ///< index in topology::cache_domains(2)
+        std::size_t l3;     ///< index in topology::cache_domains(3)
+    };
+
+    /**
+     * @brief Machine topology: physical cores with their SMT siblings, L2/L3 cache sharing groups, packages and NUMA nodes.
+     * Read from Linux sysfs, if it is unavailable every hardware thread context is considered a separate core
+     * of one package with one node and private caches. Every group is a sorted list of CPU ids
+     */
+    class topology {
+    public:
+        using cpu_group = std::vector<unsigned>;
+
+        /**
+         * @brief reads the topology from <b>system_root</b> (the directory containing <b>cpu</b> and <b>node</b>)
+         */
+        explicit topology(std::filesystem::path const & system_root = "/sys/devices/system") {
+            std::filesystem::path const cpu_root = system_root / "cpu";
+
+            std::optional<std::string> const online = read_line(cpu_root / "online");
+            cpu_group const ids = online ? parse_cpu_list(*online) : cpu_group{};
+            if (ids.empty()) {
+                make_flat(std::max(1u, std::thread::hardware_concurrency()));
+                return;
+            }
+
+            std::vector<cpu_group> const node_lists = read_node_lists(system_root / "node");
+
+            m_cpus.reserve(ids.size());
+            for (unsigned const id : ids) {
+                std::filesystem::path const cpu_dir = cpu_root / ("cpu" + std::to_string(id));
+                cpu_group const siblings = read_cpu_list(cpu_dir / "topology" / "thread_siblings_list", id);
+                cpu_group const package = read_cpu_list(cpu_dir / "topology" / "core_siblings_list", id);
+
+                logical_cpu cpu{};
+                cpu.id = id;
+                cpu.core = group_index(m_cores, siblings);
+                cpu.package = group_index(m_packages, package);
+                cpu.l2 = group_index(m_l2, read_cache_list(cpu_dir / "cache", 2, siblings));
+                cpu.l3 = group_index(m_l3, read_cache_list(cpu_dir / "cache", 3, package));
+                cpu.node = group_index(m_nodes, find_node_list(node_lists, id, ids));
+                m_cpus.push_back(cpu);
+            }
+        }
+
+        /**
+         * @brief returns the topology of this machine, read once on the first call
+         */
+        [[nodiscard]] static topology const & system() {
+            static topology const topology;
+            return topology;
+        }
+
+        [[nodiscard]] std::span<logical_cpu const> cpus() const noexcept {
+            return m_cpus;
+        }
+
+        /**
+         * @brief returns the physical cores, each is the group of its SMT siblings
+         */
+        [[nodiscard]] std::span<cpu_group const> cores() const noexcept {
+            return m_cores;
+        }
+
+        [[nodiscard]] std::span<cpu_group const> packages() const noexcept {
+            return m_packages;
+        }
+
+        [[nodiscard]] std::span<cpu_group const> nodes() const noexcept {
+            return m_nodes;
+        }
+
+        /**
+         * @brief returns the groups of CPUs sharing the cache of <b>level</b> (2 or 3)
+         */
+        [[nodiscard]] std::span<cpu_group const> cache_domains(unsigned const level) const noexcept {
+            return level == 2 ? m_l2 : m_l3;
+        }
+
+        /**
+         * @brief returns the logical CPU with <b>id</b> or nullptr if it is not online
+         */
+        [[nodiscard]] logical_cpu const * find(unsigned const id) const noexcept {
+            auto const it = std::ranges::find(m_cpus, id, &logical_cpu::id);
+            return it != m_cpus.end() ? &*it : nullptr;
+        }
+
+        /**
+         * @brief returns the number of physical cores which have CPUs in <b>group</b>
+         */
+        [[nodiscard]] std::size_t cores_count(cpu_group const & group) const {
+            std::vector<std::size_t> cores;
+            for (unsigned const id : group) {
+                if (logical_cpu const * const cpu = find(id)) {
+                    cores.push_back(cpu->core);
+                }
+            }
+            std::ranges::sort(cores);
+            return static_cast<std::size_t>(std::ranges::distance(cores.begin(), std::ranges::unique(cores).begin()));
+        }
+
+        /**
+         * @brief parses a sysfs CPU list like "0-3,8,10-11"
+         */
+        [[nodiscard]] static cpu_group parse_cpu_list(std::string const & list) {
+            cpu_group cpus;
+            std::size_t pos = 0;
+            while (pos < list.size()) {
+                std::size_t const end = std::min(list.find(',', pos), list.size());
+                std::string const range = list.substr(pos, end - pos);
+                std::size_t const dash = range.find('-');
+
+                try {
+                    unsigned const first = std::stoul(range.substr(0, dash));
+                    unsigned const last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                    for (unsigned id = first; id <= last; ++id) {
+                        cpus.push_back(id);
+                    }
+                }
+                catch (std::exception const &) {
+                    // skips malformed ranges and whitespace
+                }
+                pos = end + 1;
+            }
+
+            std::ranges::sort(cpus);
+            cpus.erase(std::ranges::unique(cpus).begin(), cpus.end());
+            return cpus;
+        }
+
+    private:
+        void make_flat(unsigned const count) {
+            for (unsigned id = 0; id < count; ++id) {
+                m_cpus.push_back({id, id, 0, 0, id, id});
+                m_cores.push_back({id});
+                m_l2.push_back({id});
+                m_l3.push_back({id});
+            }
+
+            cpu_group all(count);
+            std::ranges::generate(all, [id = 0u]() mutable { return id++; });
+            m_packages.push_back(all);
+            m_nodes.push_back(std::move(all));
+        }
+
+        [[nodiscard]] static std::optional<std::string> read_line(std::filesystem::path const & path) {
+            std::ifstream file(path);
+            std::string line;
+            if (!file || !std::getline(file, line)) {
+                return std::nullopt;
+            }
+            return line;
+        }
+
+        /**
+         * @brief reads the CPU list from <b>path</b>, returns just <b>id</b> if it is unavailable
+         */
+        [[nodiscard]] static cpu_group read_cpu_list(std::filesystem::path const & path, unsigned const id) {
+            std::optional<std::string> const line = read_line(path);
+            cpu_group list = line ? parse_cpu_list(*line) : cpu_group{};
+            return list.empty() ? cpu_group{id} : list;
+        }
+
+        /**
+         * @brief returns the CPUs sharing the data or unified cache of <b>level</b>, <b>fallback</b> if there is no such cache
+         */
+        [[nodiscard]] static cpu_group read_cache_list(std::filesystem::path const & cache_dir, unsigned const level, cpu_group const & fallback) {
+            std::error_code error;
+            for (auto const & entry : std::filesystem::directory_iterator(cache_dir, error)) {
+                if (!entry.path().filename().string().starts_with("index")) {
+                    continue;
+                }
+
+                std::optional<std::string> const entry_level = read_line(entry.path() / "level");
+                std::optional<std::string> const type = read_line(entry.path() / "type");
+                if (entry_level == std::to_string(level) && type != "Instruction") {
+                    return read_cpu_list(entry.path() / "shared_cpu_list", fallback.front());
+                }
+            }
+            return fallback;
+        }
+
+        [[nodiscard]] static std::vector<cpu_group> read_node_lists(std::filesystem::path const & node_root) {
+            std::vector<cpu_group> lists;
+            std::error_code error;
+            for (auto const & entry : std::filesystem::directory_iterator(node_root, error)) {
+                std::string const name = entry.path().filename().string();
+                if (!name.starts_with("node") || name.size() == 4 || !std::isdigit(static_cast<unsigned char>(name[4]))) {
+                    continue;
+                }
+
+                std::optional<std::string> const line = read_line(entry.path() / "cpulist");
+                if (line) {
+                    lists.push_back(parse_cpu_list(*line));
+                }
+            }
+            return lists;
+        }
+
+        /**
+         * @brief returns the node list containing <b>id</b> or all the CPUs if there is no NUMA information
+         */
+        [[nodiscard]] static cpu_group const & find_node_list(std::vector<cpu_group> const & node_lists, unsigned const id, cpu_group const & all) {
+            for (cpu_group const & list : node_lists) {
+                if (std::ranges::binary_search(list, id)) {
+                    return list;
+                }
+            }
+            return all;
+        }
+
+        /**
+         * @brief returns the index of <b>group</b> in <b>groups</b>, adding it if it is not there
+         */
+        [[nodiscard]] static std::size_t group_index(std::vector<cpu_group> & groups, cpu_group const & group) {
+            auto const it = std::ranges::find(groups, group);
+            if (it != groups.end()) {
+                return static_cast<std::size_t>(it - groups.begin());
+            }
+
+            groups.push_back(group);
+            return groups.size() - 1;
+        }
+
+    private:
+        std::vector<logical_cpu> m_cpus;
+        std::vector<cpu_group> m_cores;
+        std::vector<cpu_group> m_packages;
+        std::vector<cpu_group> m_nodes;
+        std::vector<cpu_group> m_l2;
+        std::vector<cpu_group> m_l3;
+    };
+
+}
@@ -1,10 +1,123 @@
 #pragma once
 
 #include <tuple>
+#include <array>
 #include <mutex>
+#include <algorithm>
+#include <functional>
+#include <system_error>
+
+#include <eon/mt/lock_profiler.hpp>
 
 namespace eon::mt {
 
+    /**
+     * @brief Tag selecting acquisition of multiple mutexes in the order of their addresses
+     */
+    struct address_order_t {
+        explicit address_order_t() = default;
+    };
+
+    inline constexpr address_order_t address_order{};
+
+    namespace detail {
+
+        template <bool Shared, typename Mutex>
+        void lock_one(void * const mutex) {
+            if constexpr (Shared) {
+                static_cast<Mutex *>(mutex)->lock_shared();
+            }
+            else {
+                static_cast<Mutex *>(mutex)->lock();
+            }
+        }
+
+        template <bool Shared, typename Mutex>
+        [[nodiscard]] bool try_lock_one(void * const mutex) {
+            if constexpr (Shared) {
+                return static_cast<Mutex *>(mutex)->try_lock_shared();
+            }
+            else {
+                return static_cast<Mutex *>(mutex)->try_lock();
+            }
+        }
+
+        template <bool Shared, typename Mutex>
+        void unlock_one(void * const mutex) {
+            if constexpr (Shared) {
+                static_cast<Mutex *>(mutex)->unlock_shared();
+            }
+            else {
+                static_cast<Mutex *>(mutex)->unlock();
+            }
+        }
+
+        /**
+         * @brief Mutexes of one lock sorted by address. Locking every set in this globally consistent order can't deadlock
+         * and never backs off, unlike std::lock, which retries under contention
+         */
+        template <bool Shared, std::size_t N>
+        class address_ordered_mutexes {
+            struct entry {
+                void * mutex;
+                void (*lock)(void *);
+                bool (*try_lock)(void *);
+                void (*unlock)(void *);
+            };
+
+        public:
+            template <typename... Mutexes>
+            explicit address_ordered_mutexes(Mutexes *... mutexes) noexcept
+                : m_entries{entry{mutexes, &lock_one<Shared, Mutexes>, &try_lock_one<Shared, Mutexes>, &unlock_one<Shared, Mutexes>}...} {
+                std::ranges::sort(m_entries, std::ranges::less{}, &entry::mutex);
+            }
+
+            void lock() {
+                std::size_t locked = 0;
+                try {
+                    for (; locked < N; ++locked) {
+                        m_entries[locked].lock(m_entries[locked].mutex);
+                    }
+                }
+                catch (...) {
+                    unlock_first(locked);
+                    throw;
+                }
+            }
+
+            [[nodiscard]] bool try_lock() {
+                std::size_t locked = 0;
+                try {
+                    while (locked < N && m_entries[locked].try_lock(m_entries[locked].mutex)) {
+                        ++locked;
+                    }
+                }
+                catch (...) {
+                    unlock_first(locked);
+                    throw;
+                }
+
+                if (locked == N) {
+                    return true;
+                }
+                unlock_first(locked);
+                return false;
+            }
+
+        private:
+            void unlock_first(std::size_t count) {
+                while (count != 0) {
+                    --count;
+                    m_entries[count].unlock(m_entries[count].mutex);
+                }
+            }
+
+        private:
+            std::array<entry, N> m_entries;
+        };
+
+    }
+
     template <typename... Mutexes>
     requires (sizeof...(Mutexes) > 0)
     class unique_lock {
@@ -13,7 +126,9 @@ namespace eon::mt {
             lock_impl();
         }
 
-        [[nodiscard]] explicit unique_lock(std::adopt_lock_t, Mutexes &... mutexes) noexcept : m_mutexes(std::addressof(mutexes)...), m_owns(true) {}
+        [[nodiscard]] explicit unique_lock(std::adopt_lock_t, Mutexes &... mutexes) noexcept : m_mutexes(std::addressof(mutexes)...), m_owns(true) {
+            m_probe.adopt();
+        }
 
         explicit unique_lock(std::defer_lock_t, Mutexes &... mutexes) noexcept : m_mutexes(std::addressof(mutexes)...), m_owns(false) {}
 
@@ -21,7 +136,20 @@ namespace eon::mt {
             try_lock_impl();
         }
 
-        [[nodiscard]] unique_lock(unique_lock && other) noexcept : m_mutexes(other.m_mutexes), m_owns(other.m_owns) {
+        /**
+         * @brief locks the mutexes one by one in the order of their addresses instead of std::lock's try-and-back-off.
+         * lock() keeps using this order. Deadlock-free as long as every thread locking several of these mutexes together
+         * uses address_order or std::lock
+         */
+        [[nodiscard]] explicit unique_lock(address_order_t, Mutexes &... mutexes) : m_mutexes(std::addressof(mutexes)...), m_ordered(true) {
+            lock_impl();
+        }
+
+        explicit unique_lock(std::defer_lock_t, address_order_t, Mutexes &... mutexes) noexcept
+            : m_mutexes(std::addressof(mutexes)...), m_owns(false), m_ordered(true) {}
+
+        [[nodiscard]] unique_lock(unique_lock && other) noexcept
+            : m_mutexes(other.m_mutexes), m_owns(other.m_owns), m_ordered(other.m_ordered), m_probe(other.m_probe) {
             other.m_owns = false;
         }
 
@@ -67,6 +195,8 @@ namespace eon::mt {
         void swap(unique_lock & other) noexcept {
             std::swap(m_mutexes, other.m_mutexes);
             std::swap(m_owns, other.m_owns);
+            std::swap(m_ordered, other.m_ordered);
+            std::swap(m_probe, other.m_probe);
         }
 
     private:
@@ -77,20 +207,37 @@ namespace eon::mt {
         }
 
         void lock_impl() {
-            auto impl = [](Mutexes *... mutexes) {
+            m_probe.lock(m_mutexes, [this] { return try_lock_mutexes(); }, [this] { lock_mutexes(); });
+            m_owns = true;
+        }
+
+        void try_lock_impl() {
+            m_owns = m_probe.try_lock(m_mutexes, [this] { return try_lock_mutexes(); });
+        }
+
+        void unlock_impl() {
+            m_probe.unlock(m_mutexes, [this] {
+                std::apply([](Mutexes *... mutexes) { (..., mutexes->unlock()); }, m_mutexes);
+            });
+        }
+
+        void lock_mutexes() {
+            auto impl = [this](Mutexes *... mutexes) {
                 if constexpr (sizeof...(mutexes) == 1) {
                     (mutexes->lock(), ...);
                 }
+                else if (m_ordered) {
+                    detail::address_ordered_mutexes<false, sizeof...(Mutexes)>(mutexes...).lock();
+                }
                 else {
                     std::lock(*mutexes...);
                 }
             };
 
             std::apply(impl, m_mutexes);
-            m_owns = true;
         }
 
-        void try_lock_impl() {
+        [[nodiscard]] bool try_lock_mutexes() {
             auto impl = [](Mutexes *... mutexes) {
                 if constexpr (sizeof...(mutexes) == 1) {
                     return (mutexes->try_lock() && ...) ? -1 : 0;
@@ -100,16 +247,14 @@ namespace eon::mt {
                 }
             };
 
-            m_owns = (std::apply(impl, m_mutexes) == -1);
-        }
-
-        void unlock_impl() {
-            std::apply([](Mutexes *... mutexes) { (..., mutexes->unlock()); }, m_mutexes);
+            return std::apply(impl, m_mutexes) == -1;
         }
 
     private:
         std::tuple<Mutexes *...> m_mutexes;
         bool m_owns;
+        bool m_ordered = false;
+        [[no_unique_address]] detail::lock_probe m_probe;
     };
 
 }